@@ -41,7 +41,9 @@ struct Acquisition {
     Annotated<std::string, opencmw::NoUnit, "trigger name, e.g. STREAMING or INJECTION1">        acqTriggerName      = { "STREAMING" }; // specified as ENUM
     Annotated<int64_t, si::time<nanosecond>, "UTC timestamp on which the timing event occurred"> acqTriggerTimeStamp = 0;               // specified as type WR timestamp
     Annotated<int64_t, si::time<nanosecond>, "time-stamp w.r.t. beam-in trigger">                acqLocalTimeStamp   = 0;
-    Annotated<std::vector<::int32_t>, si::time<second>, "time scale">                            channelTimeBase; // todo either nanosecond or float
+    Annotated<std::vector<::int32_t>, si::time<second>, "time scale">                            channelTimeBase; // only for non-uniformly sampled data, todo either nanosecond or float
+    Annotated<int64_t, si::time<nanosecond>, "UTC timestamp of the first sample">                channelFirstSampleTimeStamp = 0;    // 0 if unknown
+    Annotated<float, si::time<second>, "time between two samples">                               channelSampleInterval       = 0.0f; // 0 if unknown or non-uniform (see channelTimeBase)
     Annotated<float, si::time<second>, "user-defined delay">                                     channelUserDelay   = 0.0f;
     Annotated<float, si::time<second>, "actual trigger delay">                                   channelActualDelay = 0.0f;
     Annotated<std::string, opencmw::NoUnit, "name of the channel/signal">                        channelName;
@@ -52,8 +54,32 @@ struct Acquisition {
     Annotated<float, opencmw::NoUnit, "minimum expected value for channel/signal">               channelRangeMin;
     Annotated<float, opencmw::NoUnit, "maximum expected value for channel/signal">               channelRangeMax;
     Annotated<float, opencmw::NoUnit, "temperature of the measurement device">                   temperature;
+    // raw codes instead of channelValue, see TimeDomainContext::sampleFormat: int16 halves the size of the samples, int32 has the size
+    // of float but 31 instead of 24 bits of resolution across the signal range, for double sinks whose values do not fit into a float
+    Annotated<std::vector<int16_t>, opencmw::NoUnit, "raw 16-bit sample codes">                  channelRawValueInt16; // value = channelRawOffset + channelRawScale * code
+    Annotated<std::vector<int32_t>, opencmw::NoUnit, "raw 32-bit sample codes">                  channelRawValueInt32; // value = channelRawOffset + channelRawScale * code
+    Annotated<double, opencmw::NoUnit, "scale of the raw sample codes">                          channelRawScale  = 1.0;
+    Annotated<double, opencmw::NoUnit, "offset of the raw sample codes">                         channelRawOffset = 0.0;
+    Annotated<std::vector<int32_t>, opencmw::NoUnit, "number of samples per batched dataset">    batchSegmentSize;          // empty unless batched, see TimeDomainContext::maxBatchSize
+    Annotated<std::vector<int64_t>, si::time<nanosecond>, "first sample timestamp per dataset">  batchFirstSampleTimeStamp; // UTC, 0 if unknown
+    Annotated<std::vector<int64_t>, si::time<nanosecond>, "trigger timestamp per dataset">       batchTriggerTimeStamp;     // UTC, 0 if unknown
 };
 
+/**
+ * Bits of Acquisition::status. If samples were dropped since the previous update of the subscription (see
+ * TimeDomainContext::overflowPolicy), kStatusSamplesDropped is set and the upper bits hold the number of dropped samples.
+ * kStatusSamplesQuantised is set if floating point samples were sent as raw codes (TimeDomainContext::sampleFormat), i.e. the values
+ * are only accurate to channelRawScale / 2, and kStatusSamplesClipped if samples outside of channelRangeMin..channelRangeMax (or NaN)
+ * were saturated while doing so. kStatusReplyTruncated is set if a recording reply holds only the first samples of the requested range
+ * (see RecordingContext).
+ */
+constexpr int64_t kStatusSamplesDropped      = int64_t{1} << 0;
+constexpr int64_t kStatusSamplesQuantised    = int64_t{1} << 1;
+constexpr int64_t kStatusSamplesClipped      = int64_t{1} << 2;
+constexpr int64_t kStatusReplyTruncated      = int64_t{1} << 3;
+constexpr int     kStatusDroppedCountShift   = 32;                   // bits 32..62, saturating
+constexpr int64_t kStatusDroppedCountMaximum = (int64_t{1} << 31) - 1;
+
 /**
  * Generic frequency domain data object.
  * Specified in: https://edms.cern.ch/document/1823376/1 EDMS: 1823376 v.1 Section 4.3.2
@@ -77,6 +103,35 @@ struct AcquisitionSpectra {
 };
 // clang-format: ON
 
+/**
+ * Runtime statistics of the acquisition worker, with one element per poller in each of the poller* vectors. Rates and the latency
+ * histograms cover the interval since the previous report (reportInterval), byte and overrun counters are cumulative. The latency
+ * is the time from reading the (oldest) samples of an update from the sink until the update is handed to the broker.
+ */
+// clang-format: OFF
+struct AcquisitionTelemetry {
+    Annotated<int64_t, si::time<nanosecond>, "UTC timestamp of the report">                       timestamp           = 0;
+    Annotated<float, si::time<second>, "interval covered by rates and histograms">                reportInterval      = 0.0f;
+    Annotated<int32_t, opencmw::NoUnit, "number of active subscriptions">                         activeSubscriptions = 0;
+    Annotated<float, si::time<second>, "mean duration of the worker's polling cycle">             cycleDurationMean   = 0.0f;
+    Annotated<float, si::time<second>, "maximum duration of the worker's polling cycle">          cycleDurationMax    = 0.0f;
+    Annotated<int64_t, opencmw::NoUnit, "polling cycles that took longer than the update rate">   cycleOverruns       = 0;
+    Annotated<std::vector<float>, si::time<second>, "upper bounds of the latency histogram bins"> latencyBinBounds;       // the last bin (not listed) is unbounded
+    Annotated<std::vector<std::string>, opencmw::NoUnit, "signal name per poller">                pollerSignalName;
+    Annotated<std::vector<std::string>, opencmw::NoUnit, "acquisition mode per poller">           pollerAcquisitionMode;
+    Annotated<std::vector<int32_t>, opencmw::NoUnit, "subscriptions served per poller">           pollerSubscriptions;
+    Annotated<std::vector<float>, si::frequency<hertz>, "samples read per second">                pollerSampleRate;
+    Annotated<std::vector<float>, si::frequency<hertz>, "notifications sent per second">          pollerNotificationRate;
+    Annotated<std::vector<int64_t>, opencmw::NoUnit, "bytes of sample data serialised">           pollerBytesSerialised;
+    Annotated<std::vector<int64_t>, opencmw::NoUnit, "samples queued for the subscribers">        pollerQueuedSamples;
+    Annotated<std::vector<int64_t>, opencmw::NoUnit, "latency histogram per poller">              pollerLatencyHistogram; // latencyBinBounds.size() + 1 bins per poller
+};
+// clang-format: ON
+
+struct TelemetryContext {
+    opencmw::MIME::MimeType contentType = opencmw::MIME::JSON;
+};
+
 struct TimeDomainContext {
     std::string channelNameFilter;
     std::string acquisitionModeFilter = "continuous"; // one of "continuous", "triggered", "multiplexed", "snapshot"
@@ -88,22 +143,50 @@ struct TimeDomainContext {
     int32_t                 postSamples       = 0;                     // Trigger mode
     int32_t                 maximumWindowSize = 65535;                 // Multiplexed mode
     int64_t                 snapshotDelay     = 0;                     // nanoseconds, Snapshot mode
+    std::string             snapshotDelays;                            // nanoseconds, comma-separated, Snapshot mode: one update per trigger with the values at all delays (instead of snapshotDelay)
+    std::string             sampleFormat      = "float";               // one of "float", "int16", "int32" (raw codes + scale/offset, see Acquisition::channelRawValueInt16, falls back to float if the signal range is unknown)
+    int32_t                 decimationFactor  = 1;                     // > 1: min/max envelope, each bin of decimationFactor samples is sent as a (min, max) pair
+    std::string             overflowPolicy    = "drop-oldest";         // Continuous mode, "drop-oldest" or "lossless" (holds back the sink while maxQueuedSamples are queued)
+    int32_t                 maxQueuedSamples  = 1 << 20;               // Continuous mode, samples queued for the subscription between two updates
+    int32_t                 maxBatchSize      = 1;                     // Triggered/Multiplexed/Snapshot mode, > 1: datasets ready in the same cycle are sent concatenated in one update
+    int64_t                 backfillDuration  = 0;                     // nanoseconds, Continuous mode, retained history sent as one update before the live data (if the service retains history)
     opencmw::MIME::MimeType contentType       = opencmw::MIME::BINARY; // YaS
 };
 
+/// Get requests for recorded data: a time range, or if triggerNameFilter is set, a window of pre/post samples around a trigger.
+/// Replies hold at most a configured number of samples, the rest of a truncated range (kStatusReplyTruncated) is requested with a
+/// fromTime after the last sample received.
+struct RecordingContext {
+    std::string             channelNameFilter;                   // a single signal
+    int64_t                 fromTime    = 0;                     // UTC nanoseconds, time range, 0: from the oldest sample
+    int64_t                 toTime      = 0;                     // UTC nanoseconds, time range, 0: up to the newest sample
+    std::string             triggerNameFilter;                   // trigger window
+    int64_t                 triggerTime = 0;                     // UTC nanoseconds, trigger window, first trigger at or after, 0: the newest trigger
+    int32_t                 preSamples  = 0;                     // trigger window
+    int32_t                 postSamples = 0;                     // trigger window
+    opencmw::MIME::MimeType contentType = opencmw::MIME::BINARY; // YaS
+};
+
 struct FreqDomainContext {
     std::string             channelNameFilter;
     std::string             acquisitionModeFilter = "continuous"; // one of "continuous", "triggered", "multiplexed", "snapshot"
     std::string             triggerNameFilter;
     int32_t                 maxClientUpdateFrequencyFilter = 25;
+    int32_t                 fftSize                        = 1024;                  // samples per FFT, a power of two
+    int32_t                 fftOverlap                     = 0;                     // samples shared by consecutive FFTs, less than fftSize
+    int32_t                 averaging                      = 1;                     // number of consecutive magnitude spectra averaged
+    std::string             window                         = "hann";                // one of "rectangular", "hann", "hamming", "blackman-harris"
     opencmw::MIME::MimeType contentType                    = opencmw::MIME::BINARY; // YaS
 };
 
 } // namespace opendigitizer::acq
 
-ENABLE_REFLECTION_FOR(opendigitizer::acq::Acquisition, selectedFilter, acqTriggerName, acqTriggerTimeStamp, acqLocalTimeStamp, channelTimeBase, channelUserDelay, channelActualDelay, channelName, channelValue, channelError, channelUnit, status, channelRangeMin, channelRangeMax, temperature)
+ENABLE_REFLECTION_FOR(opendigitizer::acq::Acquisition, selectedFilter, acqTriggerName, acqTriggerTimeStamp, acqLocalTimeStamp, channelTimeBase, channelFirstSampleTimeStamp, channelSampleInterval, channelUserDelay, channelActualDelay, channelName, channelValue, channelError, channelUnit, status, channelRangeMin, channelRangeMax, temperature, channelRawValueInt16, channelRawValueInt32, channelRawScale, channelRawOffset, batchSegmentSize, batchFirstSampleTimeStamp, batchTriggerTimeStamp)
 ENABLE_REFLECTION_FOR(opendigitizer::acq::AcquisitionSpectra, selectedFilter, acqTriggerName, acqTriggerTimeStamp, acqLocalTimeStamp, channelName, channelMagnitude, channelMagnitude_dimensions, channelMagnitude_labels, channelMagnitude_dim1_labels, channelMagnitude_dim2_labels, channelPhase, channelPhase_labels, channelPhase_dim1_labels, channelPhase_dim2_labels)
-ENABLE_REFLECTION_FOR(opendigitizer::acq::TimeDomainContext, channelNameFilter, acquisitionModeFilter, triggerNameFilter, maxClientUpdateFrequencyFilter, preSamples, postSamples, maximumWindowSize, snapshotDelay, contentType)
-ENABLE_REFLECTION_FOR(opendigitizer::acq::FreqDomainContext, channelNameFilter, acquisitionModeFilter, triggerNameFilter, maxClientUpdateFrequencyFilter, contentType)
+ENABLE_REFLECTION_FOR(opendigitizer::acq::AcquisitionTelemetry, timestamp, reportInterval, activeSubscriptions, cycleDurationMean, cycleDurationMax, cycleOverruns, latencyBinBounds, pollerSignalName, pollerAcquisitionMode, pollerSubscriptions, pollerSampleRate, pollerNotificationRate, pollerBytesSerialised, pollerQueuedSamples, pollerLatencyHistogram)
+ENABLE_REFLECTION_FOR(opendigitizer::acq::TelemetryContext, contentType)
+ENABLE_REFLECTION_FOR(opendigitizer::acq::TimeDomainContext, channelNameFilter, acquisitionModeFilter, triggerNameFilter, maxClientUpdateFrequencyFilter, preSamples, postSamples, maximumWindowSize, snapshotDelay, snapshotDelays, sampleFormat, decimationFactor, overflowPolicy, maxQueuedSamples, maxBatchSize, backfillDuration, contentType)
+ENABLE_REFLECTION_FOR(opendigitizer::acq::RecordingContext, channelNameFilter, fromTime, toTime, triggerNameFilter, triggerTime, preSamples, postSamples, contentType)
+ENABLE_REFLECTION_FOR(opendigitizer::acq::FreqDomainContext, channelNameFilter, acquisitionModeFilter, triggerNameFilter, maxClientUpdateFrequencyFilter, fftSize, fftOverlap, averaging, window, contentType)
 
 #endif
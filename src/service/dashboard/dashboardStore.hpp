@@ -0,0 +1,433 @@
+#ifndef OPENDIGITIZER_SERVICE_DASHBOARD_STORE_HPP
+#define OPENDIGITIZER_SERVICE_DASHBOARD_STORE_HPP
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum class DashboardField : std::uint8_t { Header = 0, Dashboard = 1, Flowgraph = 2 };
+
+struct Dashboard {
+    std::string   header;
+    std::string   dashboard;
+    std::string   flowgraph;
+    std::uint64_t header_version    = 0; // store-wide sequence number of the last change of each part
+    std::uint64_t dashboard_version = 0;
+    std::uint64_t flowgraph_version = 0;
+
+    [[nodiscard]] const std::string& part(DashboardField field) const {
+        switch (field) {
+        case DashboardField::Dashboard: return dashboard;
+        case DashboardField::Flowgraph: return flowgraph;
+        case DashboardField::Header:
+        default: return header;
+        }
+    }
+
+    [[nodiscard]] std::uint64_t version(DashboardField field) const {
+        switch (field) {
+        case DashboardField::Dashboard: return dashboard_version;
+        case DashboardField::Flowgraph: return flowgraph_version;
+        case DashboardField::Header:
+        default: return header_version;
+        }
+    }
+};
+
+namespace detail {
+
+struct TransparentStringHash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view sv) const noexcept { return std::hash<std::string_view>{}(sv); }
+};
+
+inline std::uint32_t journalChecksum(std::string_view data) {
+    std::uint32_t hash = 0x811c9dc5U; // FNV-1a
+    for (const char c : data) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x01000193U;
+    }
+    return hash;
+}
+
+template<typename T>
+void appendRaw(std::string& buffer, T value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+std::optional<T> readRaw(std::string_view& data) {
+    if (data.size() < sizeof(T)) {
+        return std::nullopt;
+    }
+    T value;
+    std::memcpy(&value, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return value;
+}
+
+/// Owns a file descriptor
+class FileDescriptor {
+    int _fd = -1;
+
+public:
+    FileDescriptor() = default;
+    explicit FileDescriptor(int fd) : _fd(fd) {}
+    FileDescriptor(const FileDescriptor&)            = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    FileDescriptor(FileDescriptor&& other) noexcept : _fd(std::exchange(other._fd, -1)) {}
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+        std::swap(_fd, other._fd);
+        return *this;
+    }
+    ~FileDescriptor() {
+        if (_fd >= 0) {
+            ::close(_fd);
+        }
+    }
+
+    [[nodiscard]] int  get() const noexcept { return _fd; }
+    [[nodiscard]] bool valid() const noexcept { return _fd >= 0; }
+};
+
+inline void writeFully(int fd, std::string_view data, const std::filesystem::path& path) {
+    while (!data.empty()) {
+        const auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), fmt::format("Could not write to '{}'", path.string()));
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    if (::fdatasync(fd) != 0) {
+        throw std::system_error(errno, std::generic_category(), fmt::format("Could not sync '{}'", path.string()));
+    }
+}
+
+/// Syncs the directory entry of a created or renamed file, without that it may vanish on power loss
+inline void syncDirectory(const std::filesystem::path& directory) {
+    FileDescriptor fd(::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (!fd.valid() || ::fsync(fd.get()) != 0) {
+        throw std::system_error(errno, std::generic_category(), fmt::format("Could not sync directory '{}'", directory.string()));
+    }
+}
+
+struct YamlSection {
+    std::string_view key;
+    std::string_view text; // from the key line up to the next top-level key
+};
+
+/// Splits a block-style YAML mapping into its top-level entries, anything before the first key (comments, "---") is the preamble
+inline std::pair<std::string_view, std::vector<YamlSection>> splitYamlSections(std::string_view document) {
+    std::vector<std::pair<std::string_view, std::size_t>> keys; // key and offset of its line
+    for (std::size_t pos = 0; pos < document.size();) {
+        const auto end  = std::min(document.find('\n', pos), document.size());
+        const auto line = document.substr(pos, end - pos);
+        const auto key  = line.substr(0, line.find(':'));
+        if (key.size() < line.size() && !key.empty() && std::string_view(" \t-#\"'").find(line.front()) == std::string_view::npos && !line.starts_with("---")) {
+            keys.emplace_back(key, pos);
+        }
+        pos = end + 1;
+    }
+
+    std::vector<YamlSection> sections;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        const auto end = i + 1 < keys.size() ? keys[i + 1].second : document.size();
+        sections.push_back({keys[i].first, document.substr(keys[i].second, end - keys[i].second)});
+    }
+    return {document.substr(0, keys.empty() ? document.size() : keys.front().second), std::move(sections)};
+}
+
+} // namespace detail
+
+/**
+ * Applies a patch to a dashboard part, a YAML document with a block mapping at the top level: top-level entries of the patch
+ * replace those with the same key (keeping their position) or are appended, entries named in removedKeys are dropped. All other
+ * entries are kept verbatim, formatting and comments included.
+ */
+inline std::string patchYamlSections(std::string_view document, std::string_view patch, const std::vector<std::string_view>& removedKeys = {}) {
+    const auto [preamble, sections] = detail::splitYamlSections(document);
+    const auto patchSections        = detail::splitYamlSections(patch).second;
+
+    std::string result(preamble);
+    auto        append = [&result](std::string_view text) {
+        result += text;
+        if (!result.empty() && result.back() != '\n') {
+            result += '\n';
+        }
+    };
+    auto patched   = [&patchSections](std::string_view key) { return std::ranges::find(patchSections, key, &detail::YamlSection::key); };
+    auto isRemoved = [&removedKeys](std::string_view key) { return std::ranges::find(removedKeys, key) != removedKeys.end(); };
+
+    for (const auto& section : sections) {
+        if (isRemoved(section.key)) {
+            continue;
+        }
+        const auto it = patched(section.key);
+        append(it != patchSections.end() ? it->text : section.text);
+    }
+    for (const auto& section : patchSections) {
+        if (std::ranges::find(sections, section.key, &detail::YamlSection::key) == sections.end() && !isRemoved(section.key)) {
+            append(section.text);
+        }
+    }
+    return result;
+}
+
+/**
+ * Dashboards by name, with O(1) lookup and the names kept in creation order for listing.
+ *
+ * Every change gets the next number of a store-wide sequence as version of the changed part, and every creation also becomes the
+ * version of the list of names, so clients can ask whether anything changed since the highest version they have seen.
+ *
+ * With a directory, every change is appended to a journal ("dashboards.journal": a file magic followed by records of
+ * <payload size, FNV-1a checksum, payload>) and synced before it is applied, and the constructor recovers the state by replaying it.
+ * A torn or corrupt tail, as left by a crash during an append, is cut off. Once the journal grows beyond kCompactionRatio times the
+ * size of the live state (and at least kMinCompactionSize), it is compacted by writing the live state to a new journal that atomically
+ * replaces the old one.
+ */
+class DashboardStore {
+public:
+    static constexpr std::string_view kJournalMagic      = "ODDASH01";
+    static constexpr std::string_view kJournalFilename   = "dashboards.journal";
+    static constexpr std::size_t      kCompactionRatio   = 4;
+    static constexpr std::size_t      kMinCompactionSize = 1 << 20;
+
+private:
+    enum class RecordType : std::uint8_t {
+        Set          = 0, // without version, assigns the next in sequence on replay
+        SetVersioned = 1
+    };
+
+    std::vector<std::string>                                                                     _names;
+    std::vector<Dashboard>                                                                       _dashboards;
+    std::unordered_map<std::string, std::size_t, detail::TransparentStringHash, std::equal_to<>> _index; // name -> position in _names/_dashboards
+    std::filesystem::path                                                                        _journalPath;
+    detail::FileDescriptor                                                                       _journal;
+    std::size_t                                                                                  _journalSize = 0;
+    std::size_t                                                                                  _liveSize    = 0;     // journal size the live state compacts to
+    std::uint64_t                                                                                _sequence    = 0;     // version of the last change
+    std::uint64_t                                                                                _listVersion = 0;     // version of the last creation
+    bool                                                                                         _readOnly    = false; // set when a failed append could not be undone
+
+public:
+    /// In-memory store, nothing is persisted
+    DashboardStore() = default;
+
+    /// Persistent store in the given directory, recovering previously stored dashboards
+    explicit DashboardStore(const std::filesystem::path& directory) : _journalPath(directory / kJournalFilename) {
+        std::filesystem::create_directories(directory);
+        recover();
+        if (needsCompaction()) {
+            compact();
+        }
+    }
+
+    [[nodiscard]] bool                            persistent() const noexcept { return _journal.valid(); }
+    [[nodiscard]] bool                            empty() const noexcept { return _names.empty(); }
+    [[nodiscard]] const std::vector<std::string>& names() const noexcept { return _names; }
+    [[nodiscard]] std::size_t                     journalSize() const noexcept { return _journalSize; }
+    [[nodiscard]] std::uint64_t                   listVersion() const noexcept { return _listVersion; }
+
+    [[nodiscard]] const Dashboard* find(std::string_view name) const {
+        const auto it = _index.find(name);
+        return it != _index.end() ? &_dashboards[it->second] : nullptr;
+    }
+
+    /// Sets a field of the dashboard, creating it if it does not exist yet. Returns whether it was created.
+    bool set(std::string_view name, DashboardField field, std::string value) {
+        const auto version = _sequence + 1;
+        if (persistent()) {
+            if (_readOnly) {
+                throw std::runtime_error(fmt::format("Dashboard journal '{}' is read-only after a failed write", _journalPath.string()));
+            }
+            appendRecord(encodeSet(name, field, version, value));
+        }
+        const bool created = apply(name, field, version, std::move(value));
+        if (needsCompaction()) {
+            try {
+                compact();
+            } catch (const std::exception& e) { // the change is stored, the journal is just longer than it needs to be
+                fmt::println(std::cerr, "Could not compact dashboard journal '{}': {}", _journalPath.string(), e.what());
+            }
+        }
+        return created;
+    }
+
+    /// Rewrites the journal to contain only the live state
+    void compact() {
+        if (!persistent()) {
+            return;
+        }
+        auto        tmpPath = _journalPath;
+        std::string content(kJournalMagic);
+        for (std::size_t i = 0; i < _names.size(); ++i) {
+            const auto& ds = _dashboards[i];
+            for (const auto field : {DashboardField::Header, DashboardField::Dashboard, DashboardField::Flowgraph}) {
+                content += encodeSet(_names[i], field, ds.version(field), ds.part(field));
+            }
+        }
+        {
+            detail::FileDescriptor tmp(::open((tmpPath += ".tmp").c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+            if (!tmp.valid()) {
+                throw std::system_error(errno, std::generic_category(), fmt::format("Could not create '{}'", tmpPath.string()));
+            }
+            detail::writeFully(tmp.get(), content, tmpPath);
+        }
+        std::filesystem::rename(tmpPath, _journalPath);
+        detail::syncDirectory(_journalPath.parent_path());
+        _journal     = openJournal();
+        _journalSize = content.size();
+        _liveSize    = content.size();
+    }
+
+private:
+    /// Appends and syncs the record. A partially written record is cut off again, as records appended behind it would be lost
+    /// on recovery; if that fails too, the store refuses further changes.
+    void appendRecord(std::string_view record) {
+        try {
+            detail::writeFully(_journal.get(), record, _journalPath);
+        } catch (...) {
+            if (::ftruncate(_journal.get(), static_cast<off_t>(_journalSize)) != 0 || ::fdatasync(_journal.get()) != 0) {
+                _readOnly = true;
+            }
+            throw;
+        }
+        _journalSize += record.size();
+    }
+
+    static std::pair<std::string&, std::uint64_t&> partOf(Dashboard& ds, DashboardField field) {
+        switch (field) {
+        case DashboardField::Dashboard: return {ds.dashboard, ds.dashboard_version};
+        case DashboardField::Flowgraph: return {ds.flowgraph, ds.flowgraph_version};
+        case DashboardField::Header:
+        default: return {ds.header, ds.header_version};
+        }
+    }
+
+    static std::size_t encodedSize(std::string_view name, std::string_view value) { return 2 * sizeof(std::uint32_t) + sizeof(RecordType) + sizeof(DashboardField) + sizeof(std::uint64_t) + sizeof(std::uint32_t) + name.size() + value.size(); }
+
+    static std::string encodeSet(std::string_view name, DashboardField field, std::uint64_t version, std::string_view value) {
+        std::string payload;
+        payload.reserve(encodedSize(name, value));
+        detail::appendRaw(payload, RecordType::SetVersioned);
+        detail::appendRaw(payload, field);
+        detail::appendRaw(payload, version);
+        detail::appendRaw(payload, static_cast<std::uint32_t>(name.size()));
+        payload.append(name);
+        payload.append(value);
+
+        std::string record;
+        record.reserve(payload.size() + 2 * sizeof(std::uint32_t));
+        detail::appendRaw(record, static_cast<std::uint32_t>(payload.size()));
+        detail::appendRaw(record, detail::journalChecksum(payload));
+        record += payload;
+        return record;
+    }
+
+    bool apply(std::string_view name, DashboardField field, std::uint64_t version, std::string value) {
+        auto [it, created] = _index.try_emplace(std::string(name), _names.size());
+        if (created) {
+            _names.emplace_back(name);
+            _dashboards.emplace_back();
+            _liveSize += 3 * encodedSize(name, {});
+            _listVersion = std::max(_listVersion, version);
+        }
+        auto [target, targetVersion] = partOf(_dashboards[it->second], field);
+        _liveSize                    = _liveSize - target.size() + value.size();
+        target                       = std::move(value);
+        targetVersion                = version;
+        _sequence                    = std::max(_sequence, version);
+        return created;
+    }
+
+    [[nodiscard]] bool needsCompaction() const noexcept { return persistent() && _journalSize > std::max(kMinCompactionSize, kCompactionRatio * _liveSize); }
+
+    [[nodiscard]] detail::FileDescriptor openJournal() const {
+        detail::FileDescriptor fd(::open(_journalPath.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644));
+        if (!fd.valid()) {
+            throw std::system_error(errno, std::generic_category(), fmt::format("Could not open '{}'", _journalPath.string()));
+        }
+        return fd;
+    }
+
+    void recover() {
+        _journal = openJournal();
+        std::string content;
+        {
+            struct stat st {};
+            if (::fstat(_journal.get(), &st) != 0) {
+                throw std::system_error(errno, std::generic_category(), fmt::format("Could not stat '{}'", _journalPath.string()));
+            }
+            content.resize(static_cast<std::size_t>(st.st_size));
+            if (::pread(_journal.get(), content.data(), content.size(), 0) != static_cast<ssize_t>(content.size())) {
+                throw std::system_error(errno, std::generic_category(), fmt::format("Could not read '{}'", _journalPath.string()));
+            }
+        }
+
+        if (content.empty()) {
+            detail::writeFully(_journal.get(), kJournalMagic, _journalPath);
+            detail::syncDirectory(_journalPath.parent_path());
+            _journalSize = kJournalMagic.size();
+            _liveSize    = kJournalMagic.size();
+            return;
+        }
+        if (!std::string_view(content).starts_with(kJournalMagic)) {
+            throw std::runtime_error(fmt::format("'{}' is not a dashboard journal", _journalPath.string()));
+        }
+
+        _liveSize = kJournalMagic.size();
+        std::string_view data(content);
+        data.remove_prefix(kJournalMagic.size());
+        std::size_t records = 0;
+        while (!data.empty()) {
+            auto       record   = data;
+            const auto size     = detail::readRaw<std::uint32_t>(record);
+            const auto checksum = detail::readRaw<std::uint32_t>(record);
+            if (!size || !checksum || record.size() < *size || detail::journalChecksum(record.substr(0, *size)) != *checksum) {
+                break;
+            }
+            auto       payload = record.substr(0, *size);
+            const auto type    = detail::readRaw<RecordType>(payload);
+            const auto field   = detail::readRaw<DashboardField>(payload);
+            const auto version = type == RecordType::SetVersioned ? detail::readRaw<std::uint64_t>(payload) : std::optional(_sequence + 1);
+            const auto nameLen = detail::readRaw<std::uint32_t>(payload);
+            if ((type != RecordType::Set && type != RecordType::SetVersioned) || !field || !version || !nameLen || payload.size() < *nameLen) {
+                break;
+            }
+            apply(payload.substr(0, *nameLen), *field, *version, std::string(payload.substr(*nameLen)));
+            data.remove_prefix(2 * sizeof(std::uint32_t) + *size);
+            ++records;
+        }
+
+        _journalSize = content.size() - data.size();
+        if (!data.empty()) {
+            fmt::println(std::cerr, "Dashboard journal '{}': discarding {} bytes of incomplete or corrupt records after {} records", _journalPath.string(), data.size(), records);
+            if (::ftruncate(_journal.get(), static_cast<off_t>(_journalSize)) != 0) {
+                throw std::system_error(errno, std::generic_category(), fmt::format("Could not truncate '{}'", _journalPath.string()));
+            }
+        }
+    }
+};
+
+#endif // OPENDIGITIZER_SERVICE_DASHBOARD_STORE_HPP
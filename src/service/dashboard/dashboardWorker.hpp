@@ -4,10 +4,14 @@
 #include <majordomo/Worker.hpp>
 #include <URI.hpp>
 
+#include "dashboardStore.hpp"
+
 #include <atomic>
+#include <charconv>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <optional>
 #include <ranges>
 #include <string_view>
 #include <thread>
@@ -17,41 +21,40 @@ CMRC_DECLARE(dashboardFilesystem);
 using namespace opencmw::majordomo;
 using namespace std::chrono_literals;
 
-struct Dashboard {
-    std::string header;
-    std::string dashboard;
-    std::string flowgraph;
-};
-
 using namespace opencmw::majordomo;
 
 template<units::basic_fixed_string serviceName, typename... Meta>
 class DashboardWorker : public BasicWorker<serviceName, Meta...> {
-    std::vector<std::string> names;
-    std::vector<Dashboard>   dashboards;
-    std::mutex               lock;
+    DashboardStore store;
 
 public:
     using super_t = BasicWorker<serviceName, Meta...>;
 
+    /// Keeps the dashboards in memory only, or persists them in storageDirectory if given
     template<typename BrokerType>
-    explicit DashboardWorker(const BrokerType &broker)
-        : super_t(broker, {}) {
+    explicit DashboardWorker(const BrokerType &broker, const std::optional<std::filesystem::path> &storageDirectory = {})
+        : super_t(broker, {}), store(storageDirectory ? DashboardStore(*storageDirectory) : DashboardStore()) {
         super_t::setHandler([this](RequestContext &ctx) {
-            auto whatParam = [&]() {
+            auto param = [&](const std::string &key) -> std::optional<std::string> {
                 const auto &params = ctx.request.topic.queryParamMap();
-                auto        it     = params.find("what");
-                return it != params.end() && it->second.has_value() ? it->second.value() : std::string{};
+                auto        it     = params.find(key);
+                if (it == params.end()) {
+                    return std::nullopt;
+                }
+                return it->second.value_or(std::string{});
             };
-
-            auto getDashboard = [&](std::string_view name) -> Dashboard * {
-                auto it = std::find(names.begin(), names.end(), name);
-                if (it != names.end()) {
-                    std::string what = whatParam();
-                    auto        i    = std::size_t(it - names.begin());
-                    return &dashboards[i];
+            auto whatParam = [&]() { return param("what").value_or(std::string{}); };
+            // version the client has seen: Get replies only what changed after it, Set fails if the part changed after it
+            auto versionParam = [&]() -> std::optional<std::uint64_t> {
+                const auto value = param("version");
+                if (!value) {
+                    return std::nullopt;
                 }
-                return nullptr;
+                std::uint64_t version = 0;
+                if (const auto [end, ec] = std::from_chars(value->data(), value->data() + value->size(), version); ec != std::errc{} || end != value->data() + value->size()) {
+                    throw std::invalid_argument(fmt::format("invalid request: invalid version '{}'", *value));
+                }
+                return version;
             };
 
             auto topicPath = ctx.request.topic.path().value_or("/");
@@ -75,38 +78,44 @@ public:
             if (ctx.request.command == opencmw::mdp::Command::Get) {
                 fmt::print("worker received 'get' request\n");
 
+                const auto since = versionParam();
                 if (parts.size() == 1) {
-                    opencmw::IoBuffer buffer;
-                    opencmw::IoSerialiser<opencmw::Json, decltype(names)>::serialise(buffer, opencmw::FieldDescriptionShort{}, names);
-                    ctx.reply.data = std::move(buffer);
+                    if (!since) {
+                        ctx.reply.data = serialisedNames();
+                    } else if (store.listVersion() > *since) { // versioned reply: <version>;<names>, empty if unchanged
+                        auto        names = serialisedNames();
+                        std::string body  = fmt::format("{};", store.listVersion());
+                        body.append(reinterpret_cast<const char *>(names.data()), names.size());
+                        ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::move(body));
+                    }
                 } else if (parts.size() == 2) {
-                    if (auto *ds = getDashboard(parts[1])) {
-                        std::string      what = whatParam();
-                        std::string_view view(what);
-                        std::string      body;
+                    if (const auto *ds = store.find(parts[1])) {
+                        const auto  fields = fieldsOf(whatParam());
+                        std::string body;
 
                         // If more than one 'what' was requested we reply with all of them in the requested order.
                         // the reply format of a 'what' is <size>;<content> and they are all immediately following
                         // the previous one.
+                        // With a version, the reply is empty if none of them changed after it. Otherwise it starts with
+                        // <version>; (the latest of the requested parts) and parts that did not change are sent as -;
                         auto append = [&](std::string_view s) {
                             body += std::to_string(s.size());
                             body += ";";
                             body += s;
                         };
-                        while (true) {
-                            auto             split = view.find(',');
-                            std::string_view w(view.data(), split != view.npos ? split : view.size());
-                            if (w == "dashboard") {
-                                append(ds->dashboard);
-                            } else if (w == "flowgraph") {
-                                append(ds->flowgraph);
+                        const auto latest = std::ranges::max(fields | std::views::transform([ds](auto field) { return ds->version(field); }));
+                        if (since && latest <= *since) {
+                            return;
+                        }
+                        if (since) {
+                            body = fmt::format("{};", latest);
+                        }
+                        for (const auto field : fields) {
+                            if (since && ds->version(field) <= *since) {
+                                body += "-;";
                             } else {
-                                append(ds->header);
+                                append(ds->part(field));
                             }
-                            if (split == view.npos) {
-                                break;
-                            }
-                            view = std::string_view(view.data() + split + 1, view.size() - split - 1);
                         }
                         ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::move(body));
                     } else {
@@ -119,15 +128,6 @@ public:
                 if (parts.size() == 1) {
                     ctx.reply.error = "invalid request: dashboard not specified";
                 } else if (parts.size() == 2) {
-                    auto *ds           = getDashboard(parts[1]);
-                    bool  newDashboard = false;
-                    if (!ds) { // if we couldn't find a dashboard make a new one
-                        names.push_back(std::string(parts[1]));
-                        dashboards.push_back({});
-                        ds           = &dashboards.back();
-                        newDashboard = true;
-                    }
-
                     std::string what = whatParam();
                     auto        body = std::move(ctx.request.data);
                     // The first 4 bytes contain the size of the string, including the terminating null byte
@@ -135,25 +135,36 @@ public:
                     memcpy(&size, body.data(), 4);
                     std::string data = std::string(reinterpret_cast<char *>(body.data()) + 4, std::size_t(size - 1));
 
-                    if (what == "dashboard") {
-                        ds->dashboard = std::move(data);
-                        ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::move(ds->dashboard));
-                    } else if (what == "flowgraph") {
-                        ds->flowgraph = std::move(data);
-                        ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::move(ds->flowgraph));
+                    const auto  field    = fieldsOf(what).front();
+                    const auto  base     = versionParam();
+                    const auto  patch    = param("patch");
+                    const auto *existing = store.find(parts[1]);
+                    if (base && existing && existing->version(field) > *base) {
+                        ctx.reply.error = fmt::format("version conflict: '{}' of dashboard '{}' changed in version {}", what, parts[1], existing->version(field));
+                        return;
+                    }
+                    if (patch) {
+                        // data only carries the changed top-level sections, plus the sections to remove in 'remove'
+                        const auto                    removeParam = param("remove").value_or(std::string{});
+                        std::vector<std::string_view> removed;
+                        for (const auto key : removeParam | std::views::split(',')) {
+                            removed.emplace_back(key.begin(), key.end());
+                        }
+                        data = patchYamlSections(existing ? std::string_view(existing->part(field)) : std::string_view{}, data, removed);
+                    }
+
+                    const bool newDashboard = store.set(parts[1], field, data); // if we couldn't find a dashboard make a new one
+                    if (base || patch) {
+                        // versioned and patch requests are answered with the new version instead of the content
+                        ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::to_string(store.find(parts[1])->version(field)));
                     } else {
-                        ds->header = std::move(data);
-                        ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::move(ds->header));
+                        ctx.reply.data.put<opencmw::IoBuffer::WITHOUT>(std::move(data));
                     }
 
                     if (newDashboard) {
                         RequestContext rawCtx;
                         rawCtx.reply.topic = opencmw::URI<>("/dashboards"s);
-                        ;
-
-                        opencmw::IoBuffer buffer;
-                        opencmw::IoSerialiser<opencmw::Json, decltype(names)>::serialise(buffer, opencmw::FieldDescriptionShort{}, names);
-                        rawCtx.reply.data = std::move(buffer);
+                        rawCtx.reply.data  = serialisedNames();
 
                         super_t::notify(std::move(rawCtx.reply));
                     }
@@ -163,26 +174,35 @@ public:
                 }
             }
         });
-        auto      fs        = cmrc::dashboardFilesystem::get_filesystem();
-        auto      header    = fs.open("defaultDashboard.header");
-        auto      dashboard = fs.open("defaultDashboard.dashboard");
-        auto      flowgraph = fs.open("defaultDashboard.flowgraph");
-
-        Dashboard ds;
-        ds.header.resize(header.size());
-        std::copy(header.begin(), header.end(), ds.header.begin());
-        ds.dashboard.resize(dashboard.size());
-        std::copy(dashboard.begin(), dashboard.end(), ds.dashboard.begin());
-        ds.flowgraph.resize(flowgraph.size());
-        std::copy(flowgraph.begin(), flowgraph.end(), ds.flowgraph.begin());
-
-        names.push_back("dashboard1");
-        dashboards.push_back(ds);
-        names.push_back("dashboard2");
-        dashboards.push_back(ds);
-        names.push_back("dashboard3");
-        dashboards.push_back(ds);
+        if (store.empty()) { // first start, seed the default dashboard
+            auto fs        = cmrc::dashboardFilesystem::get_filesystem();
+            auto header    = fs.open("defaultDashboard.header");
+            auto dashboard = fs.open("defaultDashboard.dashboard");
+            auto flowgraph = fs.open("defaultDashboard.flowgraph");
+
+            store.set("dashboard1", DashboardField::Header, std::string(header.begin(), header.end()));
+            store.set("dashboard1", DashboardField::Dashboard, std::string(dashboard.begin(), dashboard.end()));
+            store.set("dashboard1", DashboardField::Flowgraph, std::string(flowgraph.begin(), flowgraph.end()));
+        }
     }
 
 private:
+    /// The dashboard parts named in a comma-separated 'what', anything unknown refers to the header
+    static std::vector<DashboardField> fieldsOf(std::string_view what) {
+        std::vector<DashboardField> fields;
+        for (const auto part : what | std::views::split(',')) {
+            const std::string_view w(part.begin(), part.end());
+            fields.push_back(w == "dashboard" ? DashboardField::Dashboard : w == "flowgraph" ? DashboardField::Flowgraph : DashboardField::Header);
+        }
+        if (fields.empty()) {
+            fields.push_back(DashboardField::Header);
+        }
+        return fields;
+    }
+
+    opencmw::IoBuffer serialisedNames() const {
+        opencmw::IoBuffer buffer;
+        opencmw::IoSerialiser<opencmw::Json, std::vector<std::string>>::serialise(buffer, opencmw::FieldDescriptionShort{}, store.names());
+        return buffer;
+    }
 };
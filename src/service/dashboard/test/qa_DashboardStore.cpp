@@ -0,0 +1,146 @@
+#include "../dashboardStore.hpp"
+#include <boost/ut.hpp>
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <sys/resource.h>
+
+const static boost::ut::suite<"DashboardStore"> dashboardStoreTests = [] {
+    using namespace boost::ut;
+    namespace fs = std::filesystem;
+
+    auto tempDirectory = [](std::string_view name) {
+        auto dir = fs::temp_directory_path() / fmt::format("qa_DashboardStore_{}_{}", name, ::getpid());
+        fs::remove_all(dir);
+        return dir;
+    };
+
+    "in-memory"_test = [] {
+        DashboardStore store;
+        expect(!store.persistent());
+        expect(store.empty());
+        expect(store.set("b", DashboardField::Header, "header b"));
+        expect(store.set("a", DashboardField::Dashboard, "dashboard a"));
+        expect(!store.set("b", DashboardField::Flowgraph, "flowgraph b"));
+        expect(store.names() == std::vector<std::string>{"b", "a"});
+        expect(store.find("a") != nullptr && store.find("a")->dashboard == "dashboard a");
+        expect(store.find("b") != nullptr && store.find("b")->header == "header b" && store.find("b")->flowgraph == "flowgraph b");
+        expect(store.find("c") == nullptr);
+    };
+
+    "recovery"_test = [&tempDirectory] {
+        const auto dir = tempDirectory("recovery");
+        {
+            DashboardStore store(dir);
+            expect(store.persistent());
+            expect(store.empty());
+            store.set("first", DashboardField::Header, "h1");
+            store.set("second", DashboardField::Dashboard, "d2");
+            store.set("first", DashboardField::Header, "h1 updated");
+        }
+        DashboardStore store(dir);
+        expect(store.names() == std::vector<std::string>{"first", "second"});
+        expect(store.find("first")->header == "h1 updated");
+        expect(store.find("second")->dashboard == "d2");
+        fs::remove_all(dir);
+    };
+
+    "torn tail"_test = [&tempDirectory] {
+        const auto dir = tempDirectory("torn");
+        std::size_t intactSize;
+        {
+            DashboardStore store(dir);
+            store.set("kept", DashboardField::Flowgraph, "fg");
+            intactSize = store.journalSize();
+            store.set("lost", DashboardField::Flowgraph, "fg");
+        }
+        const auto journal = dir / DashboardStore::kJournalFilename;
+        fs::resize_file(journal, fs::file_size(journal) - 1); // crash in the middle of the last append
+        {
+            DashboardStore store(dir);
+            expect(store.names() == std::vector<std::string>{"kept"});
+            expect(eq(store.journalSize(), intactSize));
+            store.set("after", DashboardField::Header, "h");
+        }
+        DashboardStore store(dir);
+        expect(store.names() == std::vector<std::string>{"kept", "after"});
+        fs::remove_all(dir);
+    };
+
+    "failed append"_test = [&tempDirectory] {
+        const auto dir = tempDirectory("failed");
+        {
+            DashboardStore store(dir);
+            store.set("kept", DashboardField::Header, "h");
+            const auto sizeBefore = store.journalSize();
+
+            // let the next append fail half-way, like a full disk would
+            std::signal(SIGXFSZ, SIG_IGN);
+            rlimit previous{};
+            ::getrlimit(RLIMIT_FSIZE, &previous);
+            rlimit limited   = previous;
+            limited.rlim_cur = sizeBefore + 8;
+            ::setrlimit(RLIMIT_FSIZE, &limited);
+            expect(throws([&store] { store.set("failed", DashboardField::Header, std::string(1024, 'x')); }));
+            ::setrlimit(RLIMIT_FSIZE, &previous);
+
+            expect(eq(fs::file_size(dir / DashboardStore::kJournalFilename), sizeBefore));
+            expect(store.find("failed") == nullptr);
+            store.set("after", DashboardField::Header, "h");
+        }
+        DashboardStore store(dir);
+        expect(store.names() == std::vector<std::string>{"kept", "after"});
+        fs::remove_all(dir);
+    };
+
+    "compaction"_test = [&tempDirectory] {
+        const auto        dir = tempDirectory("compaction");
+        const std::string large(64 * 1024, 'x');
+        {
+            DashboardStore store(dir);
+            for (std::size_t i = 0; i < 200; ++i) {
+                store.set("dashboard", DashboardField::Dashboard, fmt::format("{}{}", large, i));
+            }
+            expect(le(store.journalSize(), std::max(DashboardStore::kMinCompactionSize, DashboardStore::kCompactionRatio * (large.size() + 1024))));
+            expect(eq(fs::file_size(dir / DashboardStore::kJournalFilename), store.journalSize()));
+        }
+        DashboardStore store(dir);
+        expect(store.names() == std::vector<std::string>{"dashboard"});
+        expect(store.find("dashboard")->dashboard == fmt::format("{}{}", large, 199));
+        fs::remove_all(dir);
+    };
+
+    "versions"_test = [&tempDirectory] {
+        const auto dir = tempDirectory("versions");
+        {
+            DashboardStore store(dir);
+            store.set("a", DashboardField::Header, "h");
+            store.set("a", DashboardField::Dashboard, "d");
+            store.set("b", DashboardField::Header, "h");
+            store.set("a", DashboardField::Header, "h2");
+            expect(eq(store.find("a")->version(DashboardField::Header), 4UZ));
+            expect(eq(store.find("a")->version(DashboardField::Dashboard), 2UZ));
+            expect(eq(store.find("a")->version(DashboardField::Flowgraph), 0UZ));
+            expect(eq(store.listVersion(), 3UZ));
+            store.compact();
+        }
+        DashboardStore store(dir); // versions survive compaction and recovery, and keep increasing
+        expect(eq(store.find("a")->version(DashboardField::Header), 4UZ));
+        expect(eq(store.find("a")->version(DashboardField::Dashboard), 2UZ));
+        store.set("b", DashboardField::Flowgraph, "f");
+        expect(eq(store.find("b")->version(DashboardField::Flowgraph), 5UZ));
+        fs::remove_all(dir);
+    };
+
+    "patch sections"_test = [] {
+        const std::string document = "# comment\nsources:\n  - name: a\nplots:\n  - name: p\n    rect: [0, 0]\nflowgraphLayout: \"{}\"\n";
+        expect(eq(patchYamlSections(document, "plots:\n  - name: q\n"), std::string("# comment\nsources:\n  - name: a\nplots:\n  - name: q\nflowgraphLayout: \"{}\"\n")));
+        expect(eq(patchYamlSections(document, "extra: 1", {"sources", "flowgraphLayout"}), std::string("# comment\nplots:\n  - name: p\n    rect: [0, 0]\nextra: 1\n")));
+        expect(eq(patchYamlSections("", "sources: []\n"), std::string("sources: []\n")));
+    };
+};
+
+int main() { /* not needed for ut */ }
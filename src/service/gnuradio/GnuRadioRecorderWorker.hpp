@@ -0,0 +1,481 @@
+#ifndef OPENDIGITIZER_SERVICE_GNURADIORECORDERWORKER_H
+#define OPENDIGITIZER_SERVICE_GNURADIORECORDERWORKER_H
+
+#include "GnuRadioWorker.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace opendigitizer::acq {
+
+namespace detail {
+
+/// Shared read-write mapping of a file of fixed size. The file is created and its blocks are allocated up front if needed, so
+/// writing to the mapping never fails for lack of disk space.
+class MappedFile {
+    int                  _fd = -1;
+    std::span<std::byte> _data;
+
+public:
+    MappedFile(const std::filesystem::path& path, std::size_t size) {
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (_fd < 0) {
+            throw std::system_error(errno, std::generic_category(), fmt::format("Could not open '{}'", path.string()));
+        }
+        if (const auto error = ::posix_fallocate(_fd, 0, static_cast<off_t>(size)); error != 0 && (error != EOPNOTSUPP || ::ftruncate(_fd, static_cast<off_t>(size)) != 0)) {
+            ::close(_fd);
+            throw std::system_error(error, std::generic_category(), fmt::format("Could not allocate {} bytes for '{}'", size, path.string()));
+        }
+        void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        if (data == MAP_FAILED) {
+            const auto error = errno;
+            ::close(_fd);
+            throw std::system_error(error, std::generic_category(), fmt::format("Could not map '{}'", path.string()));
+        }
+        _data = std::span(static_cast<std::byte*>(data), size);
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        ::munmap(_data.data(), _data.size());
+        ::close(_fd);
+    }
+
+    [[nodiscard]] std::span<std::byte> data() const noexcept { return _data; }
+};
+
+} // namespace detail
+
+/// Layout of a recording segment file: this header, then the sample ring, the index ring and the trigger ring
+struct RecordingHeader {
+    static constexpr std::uint64_t kMagic = 0x3230'4743'4552'444fULL; // "ODRECG02", bump with layout changes
+
+    std::uint64_t magic           = 0;
+    std::uint64_t sample_capacity = 0;
+    std::uint64_t index_capacity  = 0;
+    std::uint64_t tag_capacity    = 0;
+    std::uint64_t samples_written = 0; // the counters are published with release semantics after the ring entries were written
+    std::uint64_t index_written   = 0;
+    std::uint64_t tags_written    = 0;
+    std::uint64_t samples_begun   = 0; // the *_written counters a write will publish, set before it overwrites ring entries
+    std::uint64_t index_begun     = 0;
+    std::uint64_t tags_begun      = 0;
+    float         sample_rate     = 0.f; // 0 if unknown
+    std::uint32_t reserved        = 0;
+};
+
+/// Timestamp of the first sample of a chunk, the index is ordered by both
+struct RecordingIndexRecord {
+    std::uint64_t first_sample = 0;
+    std::int64_t  timestamp    = 0; // UTC nanoseconds
+};
+
+struct RecordingTagRecord {
+    std::uint64_t        sample    = 0;
+    std::int64_t         timestamp = 0; // UTC nanoseconds
+    std::array<char, 48> trigger_name{}; // truncated, zero-terminated
+
+    [[nodiscard]] std::string_view triggerName() const noexcept { return {trigger_name.data(), ::strnlen(trigger_name.data(), trigger_name.size())}; }
+};
+
+/**
+ * The recording of one signal: rings of samples (stored as float), chunk timestamps (the index) and trigger tags in a memory-mapped
+ * segment file, which keeps the newest sample_capacity samples. Samples are addressed by their absolute index since the file was
+ * created, which survives restarts of the service. Only the recorder thread writes; like a seqlock, it announces each write in the
+ * *_begun counters before it overwrites ring entries. Readers copy from the mapped pages and then check the *_begun counters for
+ * whether the writer started to overwrite what they copied, so neither side ever waits for the other.
+ */
+class SignalRecording {
+    detail::MappedFile                                    _file;
+    RecordingHeader*                                      _header;
+    std::span<float>                                      _samples;
+    std::span<RecordingIndexRecord>                       _index;
+    std::span<RecordingTagRecord>                         _tags;
+    std::optional<std::pair<std::uint64_t, std::int64_t>> _time_reference; // writer only: absolute sample index and UTC timestamp (ns) of the last timing tag
+
+    static std::size_t fileSize(std::size_t samples, std::size_t indexRecords, std::size_t tagRecords) { return sizeof(RecordingHeader) + samples * sizeof(float) + indexRecords * sizeof(RecordingIndexRecord) + tagRecords * sizeof(RecordingTagRecord); }
+
+    static std::uint64_t load(const std::uint64_t& counter) noexcept { return std::atomic_ref(const_cast<std::uint64_t&>(counter)).load(std::memory_order_acquire); }
+    static void          store(std::uint64_t& counter, std::uint64_t value) noexcept { std::atomic_ref(counter).store(value, std::memory_order_release); }
+
+    /// First valid absolute position of a ring with the given capacity and counter
+    static std::uint64_t firstValid(std::uint64_t written, std::uint64_t capacity) noexcept { return written > capacity ? written - capacity : 0; }
+
+    /// Writer: announces that the ring entries up to the absolute position end are about to be overwritten
+    static void begin(std::uint64_t& begun, std::uint64_t end) noexcept {
+        std::atomic_ref(begun).store(end, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release); // the entries are written after the counter
+    }
+
+    /// Reader: first absolute position of a ring whose entries, copied before the call, the writer has not started to overwrite
+    static std::uint64_t firstIntact(const std::uint64_t& begun, std::uint64_t capacity) noexcept {
+        std::atomic_thread_fence(std::memory_order_acquire); // the counter is read after the entries
+        return firstValid(std::atomic_ref(const_cast<std::uint64_t&>(begun)).load(std::memory_order_relaxed), capacity);
+    }
+
+public:
+    SignalRecording(const std::filesystem::path& path, std::size_t sampleCapacity, std::size_t indexCapacity, std::size_t tagCapacity) : _file(path, fileSize(sampleCapacity, indexCapacity, tagCapacity)) {
+        auto bytes = _file.data();
+        _header    = reinterpret_cast<RecordingHeader*>(bytes.data());
+        const bool interrupted = _header->samples_begun != _header->samples_written || _header->index_begun != _header->index_written || _header->tags_begun != _header->tags_written;
+        if (_header->magic != RecordingHeader::kMagic || _header->sample_capacity != sampleCapacity || _header->index_capacity != indexCapacity || _header->tag_capacity != tagCapacity || interrupted) {
+            // new file, one recorded with another layout, or one whose last write was interrupted (e.g. by a power loss), start over
+            *_header = RecordingHeader{.magic = RecordingHeader::kMagic, .sample_capacity = sampleCapacity, .index_capacity = indexCapacity, .tag_capacity = tagCapacity};
+        }
+        bytes    = bytes.subspan(sizeof(RecordingHeader));
+        _samples = std::span(reinterpret_cast<float*>(bytes.data()), sampleCapacity);
+        bytes    = bytes.subspan(sampleCapacity * sizeof(float));
+        _index   = std::span(reinterpret_cast<RecordingIndexRecord*>(bytes.data()), indexCapacity);
+        bytes    = bytes.subspan(indexCapacity * sizeof(RecordingIndexRecord));
+        _tags    = std::span(reinterpret_cast<RecordingTagRecord*>(bytes.data()), tagCapacity);
+    }
+
+    [[nodiscard]] std::optional<float> sampleRate() const noexcept {
+        const auto rate = std::atomic_ref(_header->sample_rate).load(std::memory_order_relaxed);
+        return rate > 0.f ? std::optional(rate) : std::nullopt;
+    }
+
+    /// Range [first, end) of the absolute sample indices still held by the ring
+    [[nodiscard]] std::pair<std::uint64_t, std::uint64_t> availableSamples() const noexcept {
+        const auto written = load(_header->samples_written);
+        return {firstValid(written, _samples.size()), written};
+    }
+
+    /// The timing of samples after a gap (samples dropped by the sink) is unknown until the next timing tag
+    void markGap() noexcept { _time_reference.reset(); }
+
+    /// Appends a chunk of samples, tag indices are relative to the chunk. Called by the recorder thread only.
+    template<typename T>
+    void write(std::span<const T> data, std::span<const gr::Tag> tags) {
+        const auto firstSample = _header->samples_written;
+        for (const auto& tag : tags) {
+            if (const auto rate = detail::get<float>(tag.map, tag::SAMPLE_RATE.shortKey())) {
+                std::atomic_ref(_header->sample_rate).store(*rate, std::memory_order_relaxed);
+            }
+            if (const auto time = detail::get<std::uint64_t>(tag.map, tag::TRIGGER_TIME.shortKey())) {
+                const auto offset = detail::get<float>(tag.map, tag::TRIGGER_OFFSET.shortKey()).value_or(0.f);
+                _time_reference   = std::pair{firstSample + static_cast<std::uint64_t>(tag.index), static_cast<std::int64_t>(*time) + std::llround(static_cast<double>(offset) * 1e9)};
+            }
+        }
+        const auto now      = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const auto rate     = sampleRate();
+        auto       timeStampOf = [&](std::uint64_t sample) -> std::int64_t {
+            if (!rate) {
+                return now;
+            }
+            if (_time_reference) {
+                return _time_reference->second + std::llround((static_cast<double>(sample) - static_cast<double>(_time_reference->first)) * 1e9 / static_cast<double>(*rate));
+            }
+            // without timing tags, the newest sample is assumed to be acquired just now
+            return now - std::llround(static_cast<double>(firstSample + data.size() - sample) * 1e9 / static_cast<double>(*rate));
+        };
+
+        for (const auto& tag : tags) {
+            if (const auto name = detail::get<std::string>(tag.map, tag::TRIGGER_NAME.shortKey())) {
+                begin(_header->tags_begun, _header->tags_written + 1);
+                const auto sample = firstSample + static_cast<std::uint64_t>(tag.index);
+                auto&      record = _tags[_header->tags_written % _tags.size()];
+                record.sample     = sample;
+                record.timestamp  = timeStampOf(sample);
+                record.trigger_name.fill('\0');
+                std::ranges::copy(std::string_view(*name).substr(0, record.trigger_name.size() - 1), record.trigger_name.begin());
+                store(_header->tags_written, _header->tags_written + 1);
+            }
+        }
+
+        begin(_header->index_begun, _header->index_written + 1);
+        _index[_header->index_written % _index.size()] = RecordingIndexRecord{.first_sample = firstSample, .timestamp = timeStampOf(firstSample)};
+        store(_header->index_written, _header->index_written + 1);
+
+        // only the newest samples of chunks larger than the ring are kept
+        begin(_header->samples_begun, firstSample + data.size());
+        const auto skipped = data.size() > _samples.size() ? data.size() - _samples.size() : 0UZ;
+        auto       pos     = static_cast<std::size_t>((firstSample + skipped) % _samples.size());
+        for (auto in = data.subspan(skipped); !in.empty();) {
+            const auto n = std::min(in.size(), _samples.size() - pos);
+            std::ranges::transform(in.first(n), _samples.begin() + static_cast<std::ptrdiff_t>(pos), [](T v) { return static_cast<float>(v); });
+            in  = in.subspan(n);
+            pos = (pos + n) % _samples.size();
+        }
+        store(_header->samples_written, firstSample + data.size());
+    }
+
+    /// Copies the samples [first, end) still held by the ring to out, returns the absolute index of the first one copied
+    std::uint64_t read(std::uint64_t first, std::uint64_t end, std::vector<float>& out) const {
+        auto [available, written] = availableSamples();
+        first                     = std::max(first, available);
+        end                       = std::min(end, written);
+        out.clear();
+        if (first >= end) {
+            return first;
+        }
+        out.reserve(static_cast<std::size_t>(end - first));
+        for (auto sample = first; sample < end;) {
+            const auto pos = static_cast<std::size_t>(sample % _samples.size());
+            const auto n   = std::min(static_cast<std::size_t>(end - sample), _samples.size() - pos);
+            out.insert(out.end(), _samples.begin() + static_cast<std::ptrdiff_t>(pos), _samples.begin() + static_cast<std::ptrdiff_t>(pos + n));
+            sample += n;
+        }
+        // drop what the writer started to overwrite while copying
+        const auto overwritten = firstIntact(_header->samples_begun, _samples.size());
+        if (overwritten > first) {
+            const auto n = std::min(static_cast<std::size_t>(overwritten - first), out.size());
+            out.erase(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n));
+            first += n;
+        }
+        return first;
+    }
+
+    /// UTC timestamp (ns) of a sample, interpolated from the index; nullopt if it is not covered by the index
+    [[nodiscard]] std::optional<std::int64_t> timeStampOf(std::uint64_t sample) const noexcept {
+        const auto record = findIndexRecord([sample](const RecordingIndexRecord& r) { return r.first_sample <= sample; });
+        if (!record) {
+            return {};
+        }
+        const auto rate = sampleRate();
+        return record->timestamp + (rate ? std::llround(static_cast<double>(sample - record->first_sample) * 1e9 / static_cast<double>(*rate)) : 0);
+    }
+
+    /// Absolute index of the first sample taken at or after the given UTC timestamp (ns)
+    [[nodiscard]] std::uint64_t sampleAt(std::int64_t timeStamp) const noexcept {
+        const auto record = findIndexRecord([timeStamp](const RecordingIndexRecord& r) { return r.timestamp <= timeStamp; });
+        if (!record) {
+            return availableSamples().first; // before the oldest record
+        }
+        const auto rate = sampleRate();
+        if (!rate) {
+            return record->first_sample;
+        }
+        return record->first_sample + static_cast<std::uint64_t>(std::ceil(static_cast<double>(timeStamp - record->timestamp) * static_cast<double>(*rate) / 1e9));
+    }
+
+    /// The first trigger of the given name at or after the UTC timestamp (ns), or the newest one if timeStamp is 0
+    [[nodiscard]] std::optional<RecordingTagRecord> findTrigger(std::string_view triggerName, std::int64_t timeStamp) const {
+        while (true) {
+            const auto                                                  written = load(_header->tags_written);
+            std::optional<std::pair<std::uint64_t, RecordingTagRecord>> result; // with its absolute position
+            for (auto i = firstValid(written, _tags.size()); i < written; ++i) {
+                const auto record = _tags[i % _tags.size()];
+                if (record.triggerName() != triggerName || (timeStamp != 0 && record.timestamp < timeStamp)) {
+                    continue;
+                }
+                result = std::pair{i, record};
+                if (timeStamp != 0) {
+                    break;
+                }
+            }
+            // records the writer started to overwrite are out of the ring anyway, only a match among them needs another search
+            if (!result) {
+                return {};
+            }
+            if (result->first >= firstIntact(_header->tags_begun, _tags.size())) {
+                return result->second;
+            }
+        }
+    }
+
+private:
+    /// The last index record matching pred, for a predicate that holds for a prefix of the (ordered) index
+    template<typename Pred>
+    [[nodiscard]] std::optional<RecordingIndexRecord> findIndexRecord(Pred pred) const noexcept {
+        while (true) {
+            const auto written = load(_header->index_written);
+            const auto first   = firstValid(written, _index.size());
+            auto       lo      = first;
+            auto       hi      = written;
+            auto       oldest  = written; // oldest absolute position the search looked at
+            while (lo < hi) {
+                const auto mid = lo + (hi - lo) / 2;
+                oldest         = std::min(oldest, mid);
+                if (pred(_index[mid % _index.size()])) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            std::optional<RecordingIndexRecord> result;
+            if (lo != first) {
+                result = _index[(lo - 1) % _index.size()];
+                oldest = std::min(oldest, lo - 1);
+            }
+            // search again if the writer started to overwrite any of the records the search looked at
+            if (oldest >= firstIntact(_header->index_begun, _index.size())) {
+                return result;
+            }
+        }
+    }
+};
+
+/// Signals recorded by GnuRadioRecorderWorker and the sizes of their segment files (see SignalRecording)
+struct RecorderSettings {
+    std::filesystem::path    directory;
+    std::vector<std::string> signals;
+    std::size_t              samples_per_signal = 1UZ << 24; // 64 MiB of samples per signal
+    std::size_t              index_records      = 1UZ << 16;
+    std::size_t              tag_records        = 1UZ << 14;
+    std::size_t              max_reply_samples  = 1UZ << 22; // larger Get replies are truncated, see kStatusReplyTruncated
+};
+
+/**
+ * Records the configured signals into memory-mapped segment files (one per signal, in RecorderSettings::directory) and serves Get
+ * requests for recorded data (RecordingContext): a time range, or a window of pre/post samples around a trigger. The recorder has
+ * pollers of its own and a thread of its own, which copies the samples into the mapped pages and leaves writing them to disk to the
+ * kernel, so it never holds back the acquisition worker. Data the recorder could not keep up with is dropped by the (non-blocking)
+ * pollers, which is visible as a gap in the timestamps. Each signal is recorded to a file named after it; signals whose names map to
+ * the same file name are rejected.
+ */
+template<units::basic_fixed_string serviceName, typename... Meta>
+class GnuRadioRecorderWorker : public Worker<serviceName, RecordingContext, Empty, Acquisition, Meta...> {
+    struct Recording {
+        std::string        signal_name;
+        SignalRecording    recording;
+        AnyStreamingPoller poller; // empty if no sink of the signal exists (yet)
+
+        Recording(std::string signalName, const RecorderSettings& settings) : signal_name(std::move(signalName)), recording(settings.directory / fileNameFor(signal_name), settings.samples_per_signal, settings.index_records, settings.tag_records) {}
+    };
+
+    std::map<std::string, std::unique_ptr<Recording>, std::less<>> _recordings; // fixed after construction
+    std::size_t                                                     _max_reply_samples = 0;
+    std::jthread                                                    _recordThread;
+
+public:
+    using super_t = Worker<serviceName, RecordingContext, Empty, Acquisition, Meta...>;
+
+    explicit GnuRadioRecorderWorker(opencmw::URI<opencmw::STRICT> brokerAddress, const opencmw::zmq::Context& context, RecorderSettings recorderSettings, std::chrono::milliseconds rate, Settings settings = {}) : super_t(std::move(brokerAddress), {}, context, std::move(settings)) { init(recorderSettings, rate); }
+
+    template<typename BrokerType>
+    explicit GnuRadioRecorderWorker(const BrokerType& broker, RecorderSettings recorderSettings, std::chrono::milliseconds rate) : super_t(broker, {}) {
+        init(recorderSettings, rate);
+    }
+
+    ~GnuRadioRecorderWorker() {
+        _recordThread.request_stop();
+        _recordThread.join();
+    }
+
+private:
+    static std::string fileNameFor(std::string_view signalName) {
+        std::string name(signalName);
+        std::ranges::replace_if(name, [](char c) { return !std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.'; }, '_');
+        return name + ".rec";
+    }
+
+    void init(const RecorderSettings& recorderSettings, std::chrono::milliseconds rate) {
+        // the names are sanitised, "a/b" and "a_b" would share a file
+        std::map<std::string, std::string_view> signalByFileName;
+        for (const auto& signalName : recorderSettings.signals) {
+            if (const auto [it, inserted] = signalByFileName.emplace(fileNameFor(signalName), signalName); !inserted) {
+                throw std::invalid_argument(fmt::format("Signals '{}' and '{}' would be recorded to the same file '{}'", it->second, signalName, it->first));
+            }
+        }
+        if (!recorderSettings.signals.empty()) {
+            std::filesystem::create_directories(recorderSettings.directory);
+        }
+        _max_reply_samples = recorderSettings.max_reply_samples;
+        for (const auto& signalName : recorderSettings.signals) {
+            _recordings.emplace(signalName, std::make_unique<Recording>(signalName, recorderSettings));
+        }
+
+        super_t::setCallback([this](const RequestContext& rawCtx, const RecordingContext& filterIn, const Empty& /*in*/, RecordingContext& /*filterOut*/, Acquisition& out) {
+            if (rawCtx.request.command != opencmw::mdp::Command::Get) {
+                throw std::invalid_argument("Recordings are read-only");
+            }
+            handleGetRequest(filterIn, out);
+        });
+
+        _recordThread = std::jthread([this, rate](const std::stop_token& stoken) {
+            while (!stoken.stop_requested()) {
+                const auto cycleEnd = std::chrono::steady_clock::now() + rate;
+                for (auto& [_, recording] : _recordings) {
+                    record(*recording);
+                }
+                std::this_thread::sleep_until(cycleEnd);
+            }
+        });
+    }
+
+    static void record(Recording& recording) {
+        if (recording.poller.index() == 0) {
+            const auto query = basic::DataSinkQuery::signalName(recording.signal_name);
+            recording.poller = findPoller<AnyStreamingPoller>([&query]<typename T>() { return basic::DataSinkRegistry::instance().getStreamingPoller<T>(query, basic::BlockingMode::NonBlocking); });
+        }
+        const bool finished = std::visit(
+            [&recording]<typename TPoller>(const TPoller& poller) {
+                if constexpr (std::is_same_v<TPoller, std::monostate>) {
+                    return false;
+                } else {
+                    const auto wasFinished = poller->finished.load();
+                    if (poller->drop_count.exchange(0) > 0) {
+                        recording.recording.markGap();
+                    }
+                    std::ignore = poller->process([&recording]<typename T>(std::span<const T> data, std::span<const gr::Tag> tags) { recording.recording.write(data, tags); });
+                    return wasFinished;
+                }
+            },
+            recording.poller);
+        if (finished) {
+            // the sink was stopped, the signal may come back with the next flow graph
+            recording.poller = {};
+            recording.recording.markGap();
+        }
+    }
+
+    void handleGetRequest(const RecordingContext& filterIn, Acquisition& out) const {
+        const auto recordingIt = _recordings.find(filterIn.channelNameFilter);
+        if (recordingIt == _recordings.end()) {
+            throw std::invalid_argument(fmt::format("Signal '{}' is not recorded", filterIn.channelNameFilter));
+        }
+        const auto& recording = recordingIt->second->recording;
+
+        std::uint64_t first = 0;
+        std::uint64_t end   = 0;
+        if (!filterIn.triggerNameFilter.empty()) {
+            const auto trigger = recording.findTrigger(filterIn.triggerNameFilter, filterIn.triggerTime);
+            if (!trigger) {
+                throw std::invalid_argument(fmt::format("No trigger '{}' recorded for '{}'", filterIn.triggerNameFilter, filterIn.channelNameFilter));
+            }
+            const auto preSamples = static_cast<std::uint64_t>(std::max(filterIn.preSamples, 0));
+            first                 = trigger->sample > preSamples ? trigger->sample - preSamples : 0;
+            end                   = trigger->sample + static_cast<std::uint64_t>(std::max(filterIn.postSamples, 0));
+            out.acqTriggerName    = std::string(trigger->triggerName());
+            // Workaround for Annotated, see GnuRadioAcquisitionWorker::handleStreamingSubscription()
+            const typename decltype(out.acqTriggerTimeStamp)::R triggerTime = trigger->timestamp;
+            out.acqTriggerTimeStamp                                         = triggerTime;
+        } else {
+            first = recording.sampleAt(filterIn.fromTime);
+            end   = filterIn.toTime > 0 ? recording.sampleAt(filterIn.toTime + 1) : recording.availableSamples().second;
+        }
+
+        const auto [available, written] = recording.availableSamples();
+        first                           = std::max(first, available);
+        end                             = std::min(end, written);
+        const bool truncated            = end > first && end - first > _max_reply_samples;
+        if (truncated) {
+            end = first + _max_reply_samples;
+        }
+
+        std::vector<float> samples;
+        const auto         firstSample = recording.read(first, end, samples);
+        const auto         rate        = recording.sampleRate();
+        out.channelName                = filterIn.channelNameFilter;
+        setSamples(out, std::span(std::as_const(samples)), SampleFormat::Float);
+        setTimeBase(out, recording.timeStampOf(firstSample).value_or(0), rate ? std::optional(1.0 / static_cast<double>(*rate)) : std::nullopt);
+        if (truncated) {
+            const typename decltype(out.status)::R status = out.status.value() | kStatusReplyTruncated;
+            out.status                                    = status;
+        }
+    }
+};
+
+} // namespace opendigitizer::acq
+
+#endif // OPENDIGITIZER_SERVICE_GNURADIORECORDERWORKER_H
@@ -0,0 +1,300 @@
+#ifndef OPENDIGITIZER_SERVICE_GNURADIOSPECTRAWORKER_H
+#define OPENDIGITIZER_SERVICE_GNURADIOSPECTRAWORKER_H
+
+#include "GnuRadioWorker.hpp"
+
+#include <gnuradio-4.0/algorithm/fourier/fft.hpp>
+#include <gnuradio-4.0/algorithm/fourier/window.hpp>
+
+#include <bit>
+#include <complex>
+#include <numeric>
+#include <span>
+
+namespace opendigitizer::acq {
+
+/// FreqDomainContext::window, one of "rectangular", "hann", "hamming", "blackman-harris"
+constexpr inline gr::algorithm::window::Type parseWindowFunction(std::string_view v) {
+    using enum gr::algorithm::window::Type;
+    if (v == "rectangular") {
+        return Rectangular;
+    }
+    if (v == "hann") {
+        return Hann;
+    }
+    if (v == "hamming") {
+        return Hamming;
+    }
+    if (v == "blackman-harris") {
+        return BlackmanHarris;
+    }
+    throw std::invalid_argument(fmt::format("Invalid window function '{}'", v));
+}
+
+struct SpectrumKey {
+    std::string                 signal_name;
+    std::size_t                 fft_size  = 1024;
+    std::size_t                 overlap   = 0;
+    std::size_t                 averaging = 1;
+    gr::algorithm::window::Type window    = gr::algorithm::window::Type::Hann;
+
+    auto operator<=>(const SpectrumKey&) const noexcept = default;
+};
+
+struct SpectrumSubscriber {
+    FreqDomainContext                     context;
+    std::chrono::nanoseconds              min_update_interval = std::chrono::nanoseconds(0);
+    std::chrono::steady_clock::time_point last_update;
+    bool                                  in_use = false;
+};
+
+/**
+ * The spectra of a signal for one set of FFT parameters, shared by all subscriptions asking for these. Samples are windowed and
+ * transformed every fft_size - overlap samples, the magnitudes of 'averaging' consecutive spectra are averaged (the phase is that
+ * of the last one). Subscribers get the latest averaged spectrum, those computed in between are not sent.
+ */
+struct SpectrumEntry {
+    AnyStreamingPoller                                  poller; // empty if no sink of the signal exists (yet)
+    gr::algorithm::FFT<double, std::complex<double>>    fft;
+    std::vector<double>                                 window;
+    double                                              window_gain = 1.0; // sum of the window coefficients
+    std::vector<double>                                 windowed;          // input of the FFT
+    std::vector<std::complex<double>>                   spectrum;          // output of the FFT
+    std::vector<double>                                 history;          // samples not transformed yet, the overlap included
+    std::size_t                                         history_first = 0; // absolute index of history[0]
+    std::vector<double>                                 magnitude_sum;
+    std::size_t                                         averaged = 0;
+    std::optional<float>                                sample_rate;
+    std::optional<std::string>                          signal_name;
+    std::optional<std::pair<std::size_t, std::int64_t>> time_reference; // absolute sample index and UTC timestamp (ns) of the last timing tag
+    AcquisitionSpectra                                  reply;            // latest averaged spectrum
+    bool                                                has_update = false;
+    std::map<std::string, SpectrumSubscriber>           subscribers; // by subscription topic
+    bool                                                in_use = true;
+
+    explicit SpectrumEntry(const SpectrumKey& key) : window(gr::algorithm::window::create<double>(key.window, key.fft_size)), windowed(key.fft_size), spectrum(key.fft_size), magnitude_sum(key.fft_size / 2 + 1) {
+        window_gain = std::accumulate(window.begin(), window.end(), 0.0);
+    }
+
+    void reset() noexcept {
+        history.clear();
+        averaged = 0;
+        std::ranges::fill(magnitude_sum, 0.0);
+        time_reference.reset();
+    }
+
+    /// UTC timestamp (ns) of the sample with the given absolute index, extrapolated from the last timing tag; now if unknown
+    [[nodiscard]] std::int64_t timeStampOf(std::size_t sampleIndex) const noexcept {
+        if (!time_reference || !sample_rate || *sample_rate <= 0.f) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        const auto delta = static_cast<double>(sampleIndex) - static_cast<double>(time_reference->first);
+        return time_reference->second + std::llround(delta * 1e9 / static_cast<double>(*sample_rate));
+    }
+
+    /// Tag indices are relative to the chunk, which starts at history_first + history.size()
+    void populateFromTags(std::span<const gr::Tag> tags) {
+        const auto chunkFirst = history_first + history.size();
+        for (const auto& tag : tags) {
+            if (const auto rate = detail::get<float>(tag.map, tag::SAMPLE_RATE.shortKey())) {
+                sample_rate = rate;
+            }
+            if (const auto time = detail::get<std::uint64_t>(tag.map, tag::TRIGGER_TIME.shortKey())) {
+                const auto offset = detail::get<float>(tag.map, tag::TRIGGER_OFFSET.shortKey()).value_or(0.f);
+                time_reference    = std::pair{chunkFirst + static_cast<std::size_t>(tag.index), static_cast<std::int64_t>(*time) + std::llround(static_cast<double>(offset) * 1e9)};
+            }
+            if (const auto name = detail::get<std::string>(tag.map, tag::SIGNAL_NAME.shortKey())) {
+                signal_name = name;
+            }
+        }
+    }
+
+    /// Transforms all complete FFT windows in history, sets reply (and has_update) whenever 'averaging' spectra were summed up
+    void computeSpectra(const SpectrumKey& key) {
+        const auto  hop      = key.fft_size - key.overlap;
+        std::size_t consumed = 0;
+        for (; history.size() - consumed >= key.fft_size; consumed += hop) {
+            for (std::size_t i = 0; i < key.fft_size; ++i) {
+                windowed[i] = history[consumed + i] * window[i];
+            }
+            std::ignore = fft.compute(windowed, spectrum);
+            // single-sided amplitude spectrum, a sine of amplitude A shows as A
+            for (std::size_t k = 0; k < magnitude_sum.size(); ++k) {
+                const double scale = (k == 0 || 2 * k == key.fft_size) ? 1.0 : 2.0;
+                magnitude_sum[k] += scale * std::abs(spectrum[k]) / window_gain;
+            }
+            if (++averaged == key.averaging) {
+                setReply(key, history_first + consumed);
+                averaged = 0;
+                std::ranges::fill(magnitude_sum, 0.0);
+            }
+        }
+        history.erase(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(consumed));
+        history_first += consumed;
+    }
+
+    void setReply(const SpectrumKey& key, std::size_t firstSample) {
+        const auto nBins      = magnitude_sum.size();
+        const auto sampleRate = sample_rate.value_or(1.f); // normalised frequency (cycles per sample) if unknown
+        // Workaround for Annotated, see GnuRadioAcquisitionWorker::handleStreamingSubscription()
+        const typename decltype(reply.acqTriggerTimeStamp)::R timeStamp = timeStampOf(firstSample);
+        reply.acqTriggerTimeStamp                                       = timeStamp;
+        reply.acqTriggerName                                            = "STREAMING";
+        reply.channelName                                               = signal_name.value_or(key.signal_name);
+        reply.channelMagnitude.value().resize(nBins);
+        reply.channelPhase.value().resize(nBins);
+        reply.channelMagnitude_dim2_labels.value().resize(nBins);
+        for (std::size_t k = 0; k < nBins; ++k) {
+            reply.channelMagnitude.value()[k]             = static_cast<float>(magnitude_sum[k] / static_cast<double>(key.averaging));
+            reply.channelPhase.value()[k]                 = static_cast<float>(std::arg(spectrum[k]));
+            reply.channelMagnitude_dim2_labels.value()[k] = static_cast<float>(static_cast<double>(k) * static_cast<double>(sampleRate) / static_cast<double>(key.fft_size));
+        }
+        reply.channelMagnitude_dimensions.value()  = {1, static_cast<std::int32_t>(nBins)};
+        reply.channelMagnitude_labels.value()      = {"time", "frequency"};
+        reply.channelMagnitude_dim1_labels.value() = {static_cast<long>(timeStamp)};
+        reply.channelPhase_labels.value()          = reply.channelMagnitude_labels.value();
+        reply.channelPhase_dim1_labels.value()     = reply.channelMagnitude_dim1_labels.value();
+        reply.channelPhase_dim2_labels.value()     = reply.channelMagnitude_dim2_labels.value();
+        has_update                                 = true;
+    }
+};
+
+/**
+ * Serves magnitude and phase spectra (AcquisitionSpectra) of the flow graph's streaming signals. The windowed FFTs are computed in
+ * the service, once per signal and set of FFT parameters (FreqDomainContext::fftSize, fftOverlap, averaging, window), instead of by
+ * every client from the full time-domain data. Only the continuous acquisition mode is supported. The sinks are those of the
+ * acquisition worker's current flow graph, pollers whose sink finished (flow graph replaced) are looked up again.
+ */
+template<typename TAcquisitionWorker, units::basic_fixed_string serviceName, typename... Meta>
+class GnuRadioSpectraWorker : public Worker<serviceName, FreqDomainContext, Empty, AcquisitionSpectra, Meta...> {
+    TAcquisitionWorker& _acquisition_worker;
+    std::jthread        _notifyThread;
+
+public:
+    using super_t = Worker<serviceName, FreqDomainContext, Empty, AcquisitionSpectra, Meta...>;
+
+    explicit GnuRadioSpectraWorker(opencmw::URI<opencmw::STRICT> brokerAddress, const opencmw::zmq::Context& context, TAcquisitionWorker& acquisitionWorker, std::chrono::milliseconds rate, Settings settings = {}) : super_t(std::move(brokerAddress), {}, context, std::move(settings)), _acquisition_worker(acquisitionWorker) { init(rate); }
+
+    template<typename BrokerType>
+    explicit GnuRadioSpectraWorker(BrokerType& broker, TAcquisitionWorker& acquisitionWorker, std::chrono::milliseconds rate) : super_t(broker, {}), _acquisition_worker(acquisitionWorker) {
+        // this makes sure the subscriptions are filtered correctly
+        opencmw::query::registerTypes(FreqDomainContext(), broker);
+        init(rate);
+    }
+
+    ~GnuRadioSpectraWorker() {
+        _notifyThread.request_stop();
+        _notifyThread.join();
+    }
+
+private:
+    /// The streaming pollers are drained every 'rate', which is also how long stopping the worker may take at most
+    void init(std::chrono::milliseconds rate) {
+        _notifyThread = std::jthread([this, rate](const std::stop_token& stoken) {
+            std::map<SpectrumKey, SpectrumEntry>                        spectra;
+            std::remove_cvref_t<decltype(this->activeSubscriptions())> topics;
+
+            while (!stoken.stop_requested()) {
+                if (auto subscriptions = super_t::activeSubscriptions(); subscriptions != topics) {
+                    topics = std::move(subscriptions);
+                    updateSpectra(spectra, topics);
+                }
+                for (auto& [key, entry] : spectra) {
+                    handleSpectrum(key, entry);
+                }
+                std::this_thread::sleep_for(rate);
+            }
+        });
+    }
+
+    template<typename TTopics>
+    void updateSpectra(std::map<SpectrumKey, SpectrumEntry>& spectra, const TTopics& topics) {
+        for (auto& [_, entry] : spectra) {
+            entry.in_use = false;
+            for (auto& subscriber : entry.subscribers | std::views::values) {
+                subscriber.in_use = false;
+            }
+        }
+        for (const auto& subscription : topics) {
+            const auto filterIn = opencmw::query::deserialise<FreqDomainContext>(subscription.params());
+            try {
+                if (parseAcquisitionMode(filterIn.acquisitionModeFilter) != AcquisitionMode::Continuous) {
+                    throw std::invalid_argument(fmt::format("Acquisition mode '{}' is not supported for spectra", filterIn.acquisitionModeFilter));
+                }
+                const auto fftSize = static_cast<std::size_t>(std::max(filterIn.fftSize, 0));
+                // gr::algorithm::FFT is a radix-2 implementation
+                if (fftSize < 2 || !std::has_single_bit(fftSize)) {
+                    throw std::invalid_argument(fmt::format("Invalid FFT size {}, must be a power of two", filterIn.fftSize));
+                }
+                if (filterIn.fftOverlap < 0 || static_cast<std::size_t>(filterIn.fftOverlap) >= fftSize) {
+                    throw std::invalid_argument(fmt::format("Invalid FFT overlap {}, must be less than the FFT size", filterIn.fftOverlap));
+                }
+                const auto window = parseWindowFunction(filterIn.window);
+                for (std::string_view signalName : filterIn.channelNameFilter | std::ranges::views::split(',') | std::ranges::views::transform([](const auto&& r) { return std::string_view{&*r.begin(), std::ranges::distance(r)}; })) {
+                    const auto key     = SpectrumKey{.signal_name = std::string(signalName), .fft_size = fftSize, .overlap = static_cast<std::size_t>(filterIn.fftOverlap), .averaging = static_cast<std::size_t>(std::max(filterIn.averaging, 1)), .window = window};
+                    auto       entryIt = spectra.find(key);
+                    if (entryIt == spectra.end()) {
+                        entryIt = spectra.emplace(key, SpectrumEntry(key)).first;
+                    }
+                    entryIt->second.in_use         = true;
+                    auto& subscriber               = entryIt->second.subscribers[subscription.toZmqTopic()];
+                    subscriber.context             = filterIn;
+                    subscriber.min_update_interval = filterIn.maxClientUpdateFrequencyFilter > 0 ? std::chrono::nanoseconds(1s) / filterIn.maxClientUpdateFrequencyFilter : std::chrono::nanoseconds(0);
+                    subscriber.in_use              = true;
+                }
+            } catch (const std::exception& e) {
+                fmt::println(std::cerr, "Could not handle subscription {}: {}", subscription.toZmqTopic(), e.what());
+            }
+        }
+        // drop the pollers of old subscriptions, so the sinks do not keep data for them
+        std::erase_if(spectra, [](const auto& item) { return !item.second.in_use; });
+        for (auto& entry : spectra | std::views::values) {
+            std::erase_if(entry.subscribers, [](const auto& item) { return !item.second.in_use; });
+        }
+    }
+
+    void handleSpectrum(const SpectrumKey& key, SpectrumEntry& entry) {
+        if (entry.poller.index() == 0) {
+            entry.poller = _acquisition_worker.streamingPoller(key.signal_name, basic::BlockingMode::NonBlocking);
+        }
+        const bool finished = std::visit(
+            [&key, &entry]<typename TPoller>(const TPoller& poller) {
+                if constexpr (std::is_same_v<TPoller, std::monostate>) {
+                    return false;
+                } else {
+                    const auto wasFinished = poller->finished.load();
+                    if (poller->drop_count.exchange(0) > 0) {
+                        entry.reset(); // the FFT windows must not span a gap
+                    }
+                    std::ignore = poller->process([&key, &entry]<typename T>(std::span<const T> data, std::span<const gr::Tag> tags) {
+                        entry.populateFromTags(tags);
+                        entry.history.insert(entry.history.end(), data.begin(), data.end());
+                        entry.computeSpectra(key);
+                    });
+                    return wasFinished;
+                }
+            },
+            entry.poller);
+        if (finished) {
+            // the sink was stopped, the signal may come back with the next flow graph
+            entry.poller = {};
+            entry.reset();
+        }
+
+        if (!entry.has_update) {
+            return;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& [_, subscriber] : entry.subscribers) {
+            if (now - subscriber.last_update >= subscriber.min_update_interval) {
+                super_t::notify(subscriber.context, entry.reply);
+                subscriber.last_update = now;
+            }
+        }
+        entry.has_update = false;
+    }
+};
+
+} // namespace opendigitizer::acq
+
+#endif // OPENDIGITIZER_SERVICE_GNURADIOSPECTRAWORKER_H
@@ -11,11 +11,30 @@
 #include <gnuradio-4.0/Scheduler.hpp>
 #include <gnuradio-4.0/basic/DataSink.hpp>
 
+#include <vir/simd.h>
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <ranges>
+#include <set>
+#include <stop_token>
 #include <string_view>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <variant>
+#include <vector>
 
 namespace opendigitizer::acq {
 
@@ -34,7 +53,64 @@ inline std::optional<T> get(const gr::property_map& m, const std::string_view& k
         return {};
     }
 }
-inline float doubleToFloat(double v) { return static_cast<float>(v); }
+/// Converts the samples to float in a single SIMD pass (a plain copy for float samples), out must be at least as large as in
+template<typename T>
+inline void narrowToFloat(std::span<const T> in, std::span<float> out) noexcept {
+    if constexpr (std::is_same_v<T, float>) {
+        std::ranges::copy(in, out.begin());
+    } else {
+        using InV     = vir::stdx::native_simd<T>;
+        using FloatV  = vir::stdx::rebind_simd_t<float, InV>;
+        std::size_t i = 0;
+        for (; i + InV::size() <= in.size(); i += InV::size()) {
+            const auto v = vir::stdx::static_simd_cast<FloatV>(InV(in.data() + i, vir::stdx::element_aligned));
+            v.copy_to(out.data() + i, vir::stdx::element_aligned);
+        }
+        for (; i < in.size(); ++i) {
+            out[i] = static_cast<float>(in[i]);
+        }
+    }
+}
+
+/// Returns minimum and maximum of the (non-empty) samples, computed in a single SIMD pass
+template<typename T>
+inline std::pair<T, T> minMax(std::span<const T> in) noexcept {
+    using V        = vir::stdx::native_simd<T>;
+    T           lo = std::numeric_limits<T>::max();
+    T           hi = std::numeric_limits<T>::lowest();
+    std::size_t i  = 0;
+    if (in.size() >= V::size()) {
+        V vMin(in.data(), vir::stdx::element_aligned);
+        V vMax = vMin;
+        for (i = V::size(); i + V::size() <= in.size(); i += V::size()) {
+            const V v(in.data() + i, vir::stdx::element_aligned);
+            vMin = vir::stdx::min(vMin, v);
+            vMax = vir::stdx::max(vMax, v);
+        }
+        lo = vir::stdx::hmin(vMin);
+        hi = vir::stdx::hmax(vMax);
+    }
+    for (; i < in.size(); ++i) {
+        lo = std::min(lo, in[i]);
+        hi = std::max(hi, in[i]);
+    }
+    return {lo, hi};
+}
+
+/// Converts the samples to integer codes with value = offset + scale * code, saturating at +/- the maximum code (NaN maps to 0).
+/// Returns true if any sample was saturated or NaN.
+template<std::signed_integral TCode, typename T>
+inline bool quantise(std::span<const T> in, double offset, double scale, std::span<TCode> out) noexcept {
+    constexpr double kMaxCode = std::numeric_limits<TCode>::max();
+    const double     invScale = 1.0 / scale;
+    bool             clipped  = false;
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        const double code = std::round((static_cast<double>(in[i]) - offset) * invScale);
+        clipped           = clipped || !(std::abs(code) <= kMaxCode);
+        out[i]            = std::isnan(code) ? TCode{0} : static_cast<TCode>(std::clamp(code, -kMaxCode, kMaxCode));
+    }
+    return clipped;
+}
 
 inline std::string findTriggerName(std::span<const gr::Tag> tags) {
     for (const auto& tag : tags) {
@@ -47,6 +123,17 @@ inline std::string findTriggerName(std::span<const gr::Tag> tags) {
     return {};
 }
 
+/// Returns index and UTC timestamp (ns, including the trigger offset) of the first tag carrying a trigger time
+inline std::optional<std::pair<std::ptrdiff_t, std::int64_t>> findTriggerTime(std::span<const gr::Tag> tags) {
+    for (const auto& tag : tags) {
+        if (const auto time = get<std::uint64_t>(tag.map, gr::tag::TRIGGER_TIME.shortKey())) {
+            const auto offset = get<float>(tag.map, gr::tag::TRIGGER_OFFSET.shortKey()).value_or(0.f);
+            return std::pair{static_cast<std::ptrdiff_t>(tag.index), static_cast<std::int64_t>(*time) + std::llround(static_cast<double>(offset) * 1e9)};
+        }
+    }
+    return {};
+}
+
 template<typename T>
 inline std::optional<T> getSetting(const gr::BlockModel& block, const std::string& key) {
     try {
@@ -61,6 +148,220 @@ inline std::optional<T> getSetting(const gr::BlockModel& block, const std::strin
     }
 }
 
+/// Parses a GRC parameter value as the type of the given (current) setting, nullopt if it does not parse or the type is not supported
+inline std::optional<pmtv::pmt> parseSettingValue(const pmtv::pmt& setting, const std::string& value) {
+    return std::visit(
+        [&value]<typename T>(const T&) -> std::optional<pmtv::pmt> {
+            if constexpr (std::is_same_v<T, std::string>) {
+                return pmtv::pmt(value);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                if (value == "true" || value == "false") {
+                    return pmtv::pmt(value == "true");
+                }
+                return {};
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                T result{};
+                if (const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result); ec != std::errc{} || ptr != value.data() + value.size()) {
+                    return {};
+                }
+                return pmtv::pmt(result);
+            } else {
+                return {};
+            }
+        },
+        setting);
+}
+
+/// Blocks and everything else (connections, ...) of a GRC flow graph description, see parameterChanges()
+struct GrcDescription {
+    struct Block {
+        std::string                       definition; // YAML of the block without its parameters
+        std::map<std::string, YAML::Node> parameters;
+    };
+    std::map<std::string, Block> blocks; // by block name
+    std::string                  other;  // YAML of all top-level entries but the blocks
+
+    explicit GrcDescription(std::string_view grc) {
+        auto root = YAML::Load(std::string(grc));
+        for (const auto& blockNode : root["blocks"]) {
+            Block block;
+            for (const auto& parameter : blockNode["parameters"]) {
+                block.parameters.emplace(parameter.first.as<std::string>(), parameter.second);
+            }
+            auto definition = YAML::Clone(blockNode);
+            definition.remove("parameters");
+            block.definition = YAML::Dump(definition);
+            if (!blocks.emplace(blockNode["name"].as<std::string>(), std::move(block)).second) {
+                throw std::invalid_argument("Duplicate block name");
+            }
+        }
+        root.remove("blocks");
+        other = YAML::Dump(root);
+    }
+};
+
+using ParameterChanges = std::map<std::string, std::map<std::string, std::string>>; // by block name and parameter key
+
+/**
+ * The changed block parameters (by block name and parameter key) if that is all that differs between the two GRC descriptions,
+ * nullopt if blocks or connections were added, removed or changed otherwise, a parameter was removed or got a non-scalar value,
+ * or one of the descriptions cannot be parsed.
+ */
+inline std::optional<ParameterChanges> parameterChanges(std::string_view from, std::string_view to) {
+    try {
+        const GrcDescription oldGrc(from);
+        const GrcDescription newGrc(to);
+        if (oldGrc.other != newGrc.other || oldGrc.blocks.size() != newGrc.blocks.size()) {
+            return {};
+        }
+        ParameterChanges changes;
+        for (const auto& [name, block] : newGrc.blocks) {
+            const auto oldBlockIt = oldGrc.blocks.find(name);
+            if (oldBlockIt == oldGrc.blocks.end() || oldBlockIt->second.definition != block.definition) {
+                return {};
+            }
+            const auto& oldParameters = oldBlockIt->second.parameters;
+            if (std::ranges::any_of(oldParameters, [&block](const auto& parameter) { return !block.parameters.contains(parameter.first); })) {
+                return {};
+            }
+            for (const auto& [key, value] : block.parameters) {
+                if (const auto oldIt = oldParameters.find(key); oldIt != oldParameters.end() && YAML::Dump(oldIt->second) == YAML::Dump(value)) {
+                    continue;
+                }
+                if (!value.IsScalar()) {
+                    return {};
+                }
+                changes[name][key] = value.Scalar();
+            }
+        }
+        return changes;
+    } catch (const YAML::Exception&) {
+        return {};
+    } catch (const std::invalid_argument&) {
+        return {};
+    }
+}
+
+/**
+ * Wakes up the acquisition worker's notify thread as soon as there is something to do (a dataset for a triggered, multiplexed or
+ * snapshot subscription, a new flow graph, shutdown), instead of it sleeping for a fixed interval. Streaming data does not wake it
+ * up, streaming subscriptions are served at the fixed rate, which is the upper bound for the wait.
+ */
+class WakeupSignal {
+    std::mutex              _mutex;
+    std::condition_variable _condition;
+    std::uint64_t           _generation     = 0;
+    std::uint64_t           _seenGeneration = 0;
+
+public:
+    void notify() {
+        {
+            std::lock_guard lock(_mutex);
+            ++_generation;
+        }
+        _condition.notify_one();
+    }
+
+    /// Waits until notify() was called since the last wait returned, or until the deadline. Returns true if woken up by notify().
+    template<typename Clock, typename Duration>
+    bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+        std::unique_lock lock(_mutex);
+        const bool       woken = _condition.wait_until(lock, deadline, [this] { return _generation != _seenGeneration; });
+        _seenGeneration        = _generation;
+        return woken;
+    }
+};
+
+/**
+ * Runs a task for a range of indices on a fixed set of helper threads plus the calling thread. Used to service the pollers of the
+ * acquisition worker in parallel; with a thread count of 1, everything runs on the calling thread.
+ */
+class ParallelFor {
+    std::mutex                       _mutex;
+    std::condition_variable_any      _start;
+    std::condition_variable          _done;
+    void (*_invoke)(void*, std::size_t) = nullptr; // calls the task of the current run, which is only referenced (no allocation)
+    void*                     _task                = nullptr;
+    std::size_t               _count               = 0;
+    std::atomic<std::size_t>  _next                = 0;
+    std::size_t               _busy                = 0; // helper threads still working on the current run
+    std::uint64_t             _generation          = 0;
+    std::exception_ptr        _exception;
+    std::vector<std::jthread> _threads; // last member, so that the threads are joined before the rest is destroyed
+
+public:
+    explicit ParallelFor(std::size_t nThreads) {
+        for (std::size_t i = 1; i < nThreads; ++i) {
+            _threads.emplace_back([this](const std::stop_token& stoken) { helperLoop(stoken); });
+        }
+    }
+
+    [[nodiscard]] std::size_t threadCount() const noexcept { return _threads.size() + 1; }
+
+    /// Calls task(i) for all i in [0, count) and returns when all calls are done, rethrowing the first exception thrown by a task
+    template<std::invocable<std::size_t> TTask>
+    void run(std::size_t count, TTask&& task) {
+        if (_threads.empty() || count <= 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard lock(_mutex);
+            _invoke    = [](void* t, std::size_t i) { (*static_cast<std::remove_reference_t<TTask>*>(t))(i); };
+            _task      = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+            _count     = count;
+            _next      = 0;
+            _busy      = _threads.size();
+            _exception = nullptr;
+            ++_generation;
+        }
+        _start.notify_all();
+        work();
+
+        std::unique_lock lock(_mutex);
+        _done.wait(lock, [this] { return _busy == 0; });
+        _task = nullptr;
+        if (_exception) {
+            std::rethrow_exception(std::exchange(_exception, nullptr));
+        }
+    }
+
+private:
+    void work() {
+        for (auto i = _next++; i < _count; i = _next++) {
+            try {
+                _invoke(_task, i);
+            } catch (...) {
+                std::lock_guard lock(_mutex);
+                if (!_exception) {
+                    _exception = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void helperLoop(const std::stop_token& stoken) {
+        std::uint64_t seenGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock lock(_mutex);
+                if (!_start.wait(lock, stoken, [this, &seenGeneration] { return _generation != seenGeneration; })) {
+                    return;
+                }
+                seenGeneration = _generation;
+            }
+            work();
+            {
+                std::lock_guard lock(_mutex);
+                --_busy;
+            }
+            _done.notify_one();
+        }
+    }
+};
+
 } // namespace detail
 
 using namespace gr;
@@ -88,31 +389,470 @@ constexpr inline AcquisitionMode parseAcquisitionMode(std::string_view v) {
     throw std::invalid_argument(fmt::format("Invalid acquisition mode '{}'", v));
 }
 
+constexpr inline std::string_view acquisitionModeName(AcquisitionMode mode) {
+    using enum AcquisitionMode;
+    switch (mode) {
+    case Continuous: return "continuous";
+    case Triggered: return "triggered";
+    case Multiplexed: return "multiplexed";
+    case Snapshot: return "snapshot";
+    }
+    return {};
+}
+
+/// Sets the compact time base of the reply, per-sample channelTimeBase vectors are only used for non-uniformly sampled data
+inline void setTimeBase(Acquisition& reply, std::int64_t firstSampleTimeStamp, std::optional<double> sampleInterval) {
+    // Workaround for Annotated, see handleStreamingSubscription()
+    const typename decltype(reply.channelFirstSampleTimeStamp)::R timeStamp = firstSampleTimeStamp;
+    const typename decltype(reply.channelSampleInterval)::R       interval  = sampleInterval ? static_cast<float>(*sampleInterval) : 0.0f;
+    reply.channelFirstSampleTimeStamp                                       = timeStamp;
+    reply.channelSampleInterval                                             = interval;
+    reply.channelTimeBase.value().clear();
+}
+
+enum class SampleFormat { Float, Int16, Int32 };
+
+constexpr inline SampleFormat parseSampleFormat(std::string_view v) {
+    using enum SampleFormat;
+    if (v == "float") {
+        return Float;
+    }
+    if (v == "int16") {
+        return Int16;
+    }
+    if (v == "int32") {
+        return Int32;
+    }
+    throw std::invalid_argument(fmt::format("Invalid sample format '{}'", v));
+}
+
+/**
+ * What happens to a streaming subscription's data while it cannot be sent (TimeDomainContext::overflowPolicy): Lossless subscriptions
+ * share a blocking poller whose draining stops while any of them has maxQueuedSamples queued, holding back the sink. DropOldest
+ * subscriptions share a non-blocking poller and drop their oldest queued samples instead, so they never hold back the sink.
+ */
+enum class OverflowPolicy { Lossless, DropOldest };
+
+constexpr inline OverflowPolicy parseOverflowPolicy(std::string_view v) {
+    using enum OverflowPolicy;
+    if (v == "lossless") {
+        return Lossless;
+    }
+    if (v == "drop-oldest") {
+        return DropOldest;
+    }
+    throw std::invalid_argument(fmt::format("Invalid overflow policy '{}'", v));
+}
+
+/// Parses TimeDomainContext::snapshotDelays, a comma-separated list of delays in nanoseconds
+inline std::vector<std::chrono::nanoseconds> parseSnapshotDelays(std::string_view v) {
+    std::vector<std::chrono::nanoseconds> delays;
+    for (const auto item : v | std::views::split(',')) {
+        const auto   delay = std::string_view(item.begin(), item.end());
+        std::int64_t value = 0;
+        if (const auto [ptr, ec] = std::from_chars(delay.data(), delay.data() + delay.size(), value); ec != std::errc{} || ptr != delay.data() + delay.size()) {
+            throw std::invalid_argument(fmt::format("Invalid snapshot delay '{}'", delay));
+        }
+        delays.emplace_back(value);
+    }
+    return delays;
+}
+
+/// Acquisition::status for the given number of samples dropped since the previous update
+constexpr inline std::int64_t droppedSamplesStatus(std::uint64_t dropped) noexcept {
+    if (dropped == 0) {
+        return 0;
+    }
+    const auto count = static_cast<std::int64_t>(std::min(dropped, static_cast<std::uint64_t>(kStatusDroppedCountMaximum)));
+    return kStatusSamplesDropped | (count << kStatusDroppedCountShift);
+}
+
+/**
+ * Fills the samples of the reply in the requested format. The integer formats send raw codes spanning channelRangeMin..channelRangeMax,
+ * with value = channelRawOffset + channelRawScale * code, and set kStatusSamplesQuantised (plus kStatusSamplesClipped if samples were
+ * outside of the range) in the status. Without a known signal range, the samples are sent as float. Samples of int16 sinks are sent
+ * as they are (scale 1, offset 0) in both integer formats. Overwrites the status of the reply.
+ */
+template<typename T>
+inline void setSamples(Acquisition& reply, std::span<const T> samples, SampleFormat format) {
+    reply.channelValue.value().clear();
+    reply.channelRawValueInt16.value().clear();
+    reply.channelRawValueInt32.value().clear();
+
+    const float  rangeMin     = reply.channelRangeMin.value();
+    const float  rangeMax     = reply.channelRangeMax.value();
+    const double range        = static_cast<double>(rangeMax) - static_cast<double>(rangeMin);
+    const bool   rangeUnknown = rangeMin == std::numeric_limits<float>::lowest() || rangeMax == std::numeric_limits<float>::max() || !std::isfinite(range) || range <= 0.0;
+
+    // Workaround for Annotated, see handleStreamingSubscription()
+    typename decltype(reply.channelRawScale)::R  scale  = 1.0;
+    typename decltype(reply.channelRawOffset)::R offset = 0.0;
+    typename decltype(reply.status)::R           status = 0;
+    if constexpr (std::is_same_v<T, std::int16_t>) {
+        if (format == SampleFormat::Int16) {
+            reply.channelRawValueInt16.value().assign(samples.begin(), samples.end());
+        } else if (format == SampleFormat::Int32) {
+            reply.channelRawValueInt32.value().assign(samples.begin(), samples.end());
+        }
+        if (format != SampleFormat::Float) {
+            reply.channelRawScale  = scale;
+            reply.channelRawOffset = offset;
+            reply.status           = status;
+            return;
+        }
+    }
+    if (format == SampleFormat::Float || rangeUnknown) {
+        reply.channelValue.resize(samples.size());
+        detail::narrowToFloat(samples, reply.channelValue.value());
+    } else if (format == SampleFormat::Int16) {
+        offset = 0.5 * (static_cast<double>(rangeMin) + static_cast<double>(rangeMax));
+        scale  = range / (2.0 * std::numeric_limits<std::int16_t>::max());
+        reply.channelRawValueInt16.resize(samples.size());
+        const bool clipped = detail::quantise<std::int16_t>(samples, offset, scale, std::span(reply.channelRawValueInt16.value()));
+        status             = kStatusSamplesQuantised | (clipped ? kStatusSamplesClipped : 0);
+    } else {
+        offset = 0.5 * (static_cast<double>(rangeMin) + static_cast<double>(rangeMax));
+        scale  = range / (2.0 * std::numeric_limits<std::int32_t>::max());
+        reply.channelRawValueInt32.resize(samples.size());
+        const bool clipped = detail::quantise<std::int32_t>(samples, offset, scale, std::span(reply.channelRawValueInt32.value()));
+        status             = kStatusSamplesQuantised | (clipped ? kStatusSamplesClipped : 0);
+    }
+    reply.channelRawScale  = scale;
+    reply.channelRawOffset = offset;
+    reply.status           = status;
+}
+
+/**
+ * The sample types of the DataSinks the acquisition worker serves natively. A sink's sample type is only known from the registry,
+ * so pollers are requested for each type in turn until one matches (see findPoller()). There is no complex variant, as Acquisition
+ * has no representation for complex samples.
+ */
+template<template<typename...> typename TFor>
+using ForSinkSampleTypes = std::variant<std::monostate, TFor<double>, TFor<float>, TFor<std::int16_t>>;
+
+template<typename T>
+using StreamingPollerPtr = std::shared_ptr<typename gr::basic::DataSink<T>::Poller>;
+template<typename T>
+using DataSetPollerPtr   = std::shared_ptr<typename gr::basic::DataSink<T>::DataSetPoller>;
+using AnyStreamingPoller = ForSinkSampleTypes<StreamingPollerPtr>;
+using AnyDataSetPoller   = ForSinkSampleTypes<DataSetPollerPtr>;
+using AnySampleBuffer    = ForSinkSampleTypes<std::vector>;
+
+/// Calls fnc.template operator()<T>() for the sink sample types, in order, until it returns true
+template<typename TFnc>
+inline bool forSinkSampleTypes(TFnc&& fnc) {
+    return fnc.template operator()<double>() || fnc.template operator()<float>() || fnc.template operator()<std::int16_t>();
+}
+
+/// Returns the poller getPoller.template operator()<T>() gives for the first matching sample type, or an empty variant
+template<typename TAnyPoller, typename TGetPoller>
+inline TAnyPoller findPoller(TGetPoller&& getPoller) {
+    TAnyPoller result;
+    std::ignore = forSinkSampleTypes([&result, &getPoller]<typename T>() {
+        auto poller = getPoller.template operator()<T>();
+        if (poller) {
+            result = std::move(poller);
+        }
+        return result.index() != 0;
+    });
+    return result;
+}
+
+/// The buffer holding samples of type T, (re)initialised if it held another type before
+template<typename T>
+inline std::vector<T>& samplesOf(AnySampleBuffer& buffer) {
+    if (!std::holds_alternative<std::vector<T>>(buffer)) {
+        buffer.template emplace<std::vector<T>>();
+    }
+    return std::get<std::vector<T>>(buffer);
+}
+
+// The window sizes are not part of the key, the dataset pollers are shared by all subscriptions with different windows
 struct PollerKey {
     AcquisitionMode          mode;
     std::string              signal_name;
-    std::size_t              pre_samples         = 0;                           // Trigger
-    std::size_t              post_samples        = 0;                           // Trigger
-    std::size_t              maximum_window_size = 0;                           // Multiplexed
-    std::chrono::nanoseconds snapshot_delay      = std::chrono::nanoseconds(0); // Snapshot
-    std::string              trigger_name        = {};                          // Trigger, Multiplexed, Snapshot
+    std::chrono::nanoseconds snapshot_delay  = std::chrono::nanoseconds(0); // Snapshot
+    std::string              trigger_name    = {};                          // Trigger, Multiplexed, Snapshot
+    bool                     snapshot_window = false;                       // Snapshot with multiple delays, read from a trigger window
+    OverflowPolicy           overflow_policy = OverflowPolicy::DropOldest;  // Continuous
 
     auto operator<=>(const PollerKey&) const noexcept = default;
 };
 
+/**
+ * Min/max envelope decimation (TimeDomainContext::decimationFactor): each bin of 'factor' input samples is reduced to a (min, max)
+ * pair. Bins can span multiple chunks of streaming data, the incomplete bin is kept until the next call or flushed explicitly.
+ */
+struct MinMaxDecimator {
+    std::size_t factor   = 1;
+    std::size_t bin_fill = 0;
+    double      bin_min  = 0.; // double represents all sink sample types exactly
+    double      bin_max  = 0.;
+
+    template<typename T>
+    void process(std::span<const T> in, std::vector<T>& out) {
+        if (bin_fill > 0) {
+            const auto n        = std::min(factor - bin_fill, in.size());
+            const auto [lo, hi] = detail::minMax(in.first(n));
+            bin_min             = std::min(bin_min, static_cast<double>(lo));
+            bin_max             = std::max(bin_max, static_cast<double>(hi));
+            bin_fill += n;
+            in = in.subspan(n);
+            if (bin_fill == factor) {
+                flush(out);
+            }
+        }
+        for (; in.size() >= factor; in = in.subspan(factor)) {
+            const auto [lo, hi] = detail::minMax(in.first(factor));
+            out.push_back(lo);
+            out.push_back(hi);
+        }
+        if (!in.empty()) {
+            std::tie(bin_min, bin_max) = detail::minMax(in);
+            bin_fill                   = in.size();
+        }
+    }
+
+    template<typename T>
+    void flush(std::vector<T>& out) {
+        if (bin_fill > 0) {
+            out.push_back(static_cast<T>(bin_min)); // exact, the bins only ever hold values of type T
+            out.push_back(static_cast<T>(bin_max));
+            bin_fill = 0;
+        }
+    }
+};
+
+/**
+ * Counters of a poller for the telemetry property (AcquisitionTelemetry). They are updated by the thread servicing the poller and
+ * read by the notify thread between two cycles. Sample, notification and latency counts cover the current report interval.
+ */
+struct PollerStatistics {
+    static constexpr std::array kLatencyBinBounds = {1ms, 2ms, 5ms, 10ms, 20ms, 50ms, 100ms, 200ms, 500ms, 1000ms};
+
+    std::uint64_t                                           samples          = 0;
+    std::uint64_t                                           notifications    = 0;
+    std::uint64_t                                           bytes_serialised = 0; // cumulative
+    std::array<std::uint64_t, kLatencyBinBounds.size() + 1> latency_histogram{};
+
+    /// Records a notification sent latency after its oldest samples were read from the sink
+    void recordNotification(const Acquisition& reply, std::chrono::nanoseconds latency) noexcept {
+        ++notifications;
+        bytes_serialised += sizeof(float) * (reply.channelValue.value().size() + reply.channelError.value().size()) + sizeof(std::int16_t) * reply.channelRawValueInt16.value().size() + sizeof(std::int32_t) * reply.channelRawValueInt32.value().size();
+        ++latency_histogram[static_cast<std::size_t>(std::ranges::upper_bound(kLatencyBinBounds, latency) - kLatencyBinBounds.begin())];
+    }
+
+    void resetInterval() noexcept {
+        samples       = 0;
+        notifications = 0;
+        latency_histogram.fill(0);
+    }
+};
+
+/// Durations of the notify thread's polling cycles for the telemetry property, see PollerStatistics
+struct CycleStatistics {
+    std::chrono::nanoseconds total{0};
+    std::chrono::nanoseconds longest{0};
+    std::uint64_t            cycles   = 0;
+    std::uint64_t            overruns = 0; // cumulative
+
+    void record(std::chrono::nanoseconds duration, std::chrono::nanoseconds rate) noexcept {
+        total += duration;
+        longest = std::max(longest, duration);
+        ++cycles;
+        if (duration > rate) {
+            ++overruns;
+        }
+    }
+
+    void resetInterval() noexcept {
+        total   = std::chrono::nanoseconds(0);
+        longest = std::chrono::nanoseconds(0);
+        cycles  = 0;
+    }
+};
+
+/**
+ * A streaming subscription of a signal. Updates are sent at most with the subscription's maxClientUpdateFrequencyFilter, the data
+ * received in between is merged into the next update. At most max_queued values are kept for that, see OverflowPolicy.
+ */
+struct StreamingSubscriber {
+    TimeDomainContext                     context;
+    SampleFormat                          sample_format       = SampleFormat::Float;
+    std::chrono::nanoseconds              min_update_interval = std::chrono::nanoseconds(0);
+    std::chrono::steady_clock::time_point last_update;
+    AnySampleBuffer                       pending;                  // samples (or min/max pairs if decimating) received since the last update
+    std::size_t                           pending_first_sample = 0; // absolute index of the first sample in pending
+    std::chrono::steady_clock::time_point pending_since;            // when the first sample in pending was read from the sink
+    MinMaxDecimator                       decimator;
+    OverflowPolicy                        overflow_policy = OverflowPolicy::DropOldest;
+    std::size_t                           max_queued      = std::numeric_limits<std::size_t>::max(); // bound for the size of pending
+    std::uint64_t                         dropped         = 0;                                       // samples dropped since the last update
+    bool                                  in_use          = false;
+
+    [[nodiscard]] bool isDue(std::chrono::steady_clock::time_point now) const noexcept { return now - last_update >= min_update_interval; }
+
+    [[nodiscard]] std::size_t pendingSize() const noexcept {
+        return std::visit([]<typename TBuffer>(const TBuffer& buffer) -> std::size_t {
+            if constexpr (std::is_same_v<TBuffer, std::monostate>) {
+                return 0UZ;
+            } else {
+                return buffer.size();
+            }
+        }, pending);
+    }
+
+    /// Number of input samples that can still be queued in pending, unbounded if they will be sent right away
+    [[nodiscard]] std::size_t queueCapacity(std::chrono::steady_clock::time_point now) const noexcept {
+        const auto queued = pendingSize();
+        if (decimator.factor <= 1 && queued == 0 && isDue(now)) {
+            return std::numeric_limits<std::size_t>::max();
+        }
+        const auto free = max_queued > queued ? max_queued - queued : 0UZ;
+        return decimator.factor > 1 ? free / 2 * decimator.factor : free; // two values per bin
+    }
+
+    /// For DropOldest, drops the oldest values from the queue (pending) until it fits max_queued again
+    template<typename T>
+    void dropOldest(std::vector<T>& queue) {
+        if (overflow_policy != OverflowPolicy::DropOldest || queue.size() <= max_queued) {
+            return;
+        }
+        auto excess = queue.size() - max_queued;
+        if (decimator.factor > 1) {
+            excess += excess % 2; // keep (min, max) pairs intact
+        }
+        const auto droppedSamples = decimator.factor > 1 ? excess / 2 * decimator.factor : excess;
+        queue.erase(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(excess));
+        pending_first_sample += droppedSamples;
+        dropped += droppedSamples;
+    }
+};
+
+/// Duration and memory budget (sample data of all signals together) of the history retained for backfills, see HistoryRing
+struct HistoryRetention {
+    std::chrono::nanoseconds duration  = std::chrono::nanoseconds(0); // 0 disables the retention
+    std::size_t              max_bytes = 64UZ << 20;
+
+    auto operator<=>(const HistoryRetention&) const noexcept = default;
+};
+
+/**
+ * The most recent samples of a signal, fed by its streaming poller and sent to new subscriptions as one bulk update before their
+ * live data (TimeDomainContext::backfillDuration). Holds at most the retention duration (if the sample rate is known) and at most
+ * the share of the memory budget of the signal. A gap in the data (samples dropped by the sink) clears the history.
+ */
+struct HistoryRing {
+    ForSinkSampleTypes<std::deque> samples;
+    std::size_t                    end_sample = 0; // absolute index after the newest sample
+    std::chrono::nanoseconds       duration   = std::chrono::nanoseconds(0);
+    std::size_t                    max_bytes  = 0;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return std::visit([]<typename TBuffer>(const TBuffer& buffer) -> std::size_t {
+            if constexpr (std::is_same_v<TBuffer, std::monostate>) {
+                return 0UZ;
+            } else {
+                return buffer.size();
+            }
+        }, samples);
+    }
+
+    void clear() noexcept { samples = {}; }
+
+    template<typename T>
+    void append(std::span<const T> data, std::size_t firstSample, std::optional<float> sampleRate) {
+        if (!std::holds_alternative<std::deque<T>>(samples) || firstSample != end_sample) {
+            samples.template emplace<std::deque<T>>();
+        }
+        auto&      history  = std::get<std::deque<T>>(samples);
+        const auto capacity = capacityFor<T>(sampleRate);
+        if (data.size() >= capacity) {
+            history.assign(data.end() - static_cast<std::ptrdiff_t>(capacity), data.end());
+        } else {
+            history.insert(history.end(), data.begin(), data.end());
+            if (history.size() > capacity) {
+                history.erase(history.begin(), history.begin() + static_cast<std::ptrdiff_t>(history.size() - capacity));
+            }
+        }
+        end_sample = firstSample + data.size();
+    }
+
+    /// Copies the newest (at most maxSamples) samples to out, returns the absolute index of the first one
+    template<typename T>
+    std::size_t copyLatest(std::size_t maxSamples, std::vector<T>& out) const {
+        const auto& history = std::get<std::deque<T>>(samples);
+        const auto  n       = std::min(maxSamples, history.size());
+        out.assign(history.end() - static_cast<std::ptrdiff_t>(n), history.end());
+        return end_sample - n;
+    }
+
+private:
+    template<typename T>
+    [[nodiscard]] std::size_t capacityFor(std::optional<float> sampleRate) const noexcept {
+        auto capacity = max_bytes / sizeof(T);
+        if (sampleRate && *sampleRate > 0.f) {
+            capacity = std::min(capacity, static_cast<std::size_t>(std::ceil(std::chrono::duration<double>(duration).count() * static_cast<double>(*sampleRate))));
+        }
+        return capacity;
+    }
+};
+
 struct StreamingPollerEntry {
-    using SampleType                                                = double;
     bool                                                     in_use = true;
-    std::shared_ptr<gr::basic::DataSink<SampleType>::Poller> poller;
+    bool                                                     failed = false; // servicing threw, the entry is dropped and created anew
+    AnyStreamingPoller                                       poller;            // empty if no sink of the signal exists (yet)
+    AnyStreamingPoller                                       next_poller;       // on the sink of the replacing flow graph while migrating
+    bool                                                     migrating = false; // the flow graph of poller is being replaced, see cutOver()
     std::optional<std::string>                               signal_name;
     std::optional<std::string>                               signal_unit;
     std::optional<float>                                     signal_min;
     std::optional<float>                                     signal_max;
+    std::optional<float>                                     sample_rate;
+    std::size_t                                              samples_seen = 0; // absolute index of the next sample
+    std::optional<std::pair<std::size_t, std::int64_t>>      time_reference;   // absolute sample index and UTC timestamp (ns) of the last timing tag
+    Acquisition                                              reply;            // reused between updates to keep the capacity of the sample vectors
+    std::map<std::string, StreamingSubscriber>               subscribers;      // by subscription topic
+    PollerStatistics                                         statistics;
+    bool                                                     retain_history = false; // kept (and serviced) without subscribers as well
+    HistoryRing                                              history;
+
+    explicit StreamingPollerEntry(AnyStreamingPoller p) : poller{std::move(p)} {}
+
+    /// UTC timestamp (ns) of the sample with the given absolute index, extrapolated from the last timing tag; 0 if unknown
+    [[nodiscard]] std::int64_t timeStampOf(std::size_t sampleIndex) const noexcept {
+        if (!time_reference || !sample_rate || *sample_rate <= 0.f) {
+            return 0;
+        }
+        const auto delta = static_cast<double>(sampleIndex) - static_cast<double>(time_reference->first);
+        return time_reference->second + std::llround(delta * 1e9 / static_cast<double>(*sample_rate));
+    }
+
+    [[nodiscard]] std::optional<double> sampleInterval(std::size_t decimationFactor) const noexcept {
+        if (!sample_rate || *sample_rate <= 0.f) {
+            return {};
+        }
+        // the min/max envelope has two points per bin
+        return decimationFactor > 1 ? static_cast<double>(decimationFactor) / (2.0 * static_cast<double>(*sample_rate)) : 1.0 / static_cast<double>(*sample_rate);
+    }
 
-    explicit StreamingPollerEntry(std::shared_ptr<basic::DataSink<SampleType>::Poller> p) : poller{p} {}
+    /// Continues with the poller on the sink of the replacing flow graph, once the old one finished and was drained
+    void cutOver() noexcept {
+        poller    = std::exchange(next_poller, {});
+        migrating = false;
+        time_reference.reset(); // the new sink starts with its own timing tags
+    }
 
+    /// Tag indices are relative to the current chunk, which starts at samples_seen
     void populateFromTags(std::span<const gr::Tag>& tags) {
         for (const auto& tag : tags) {
+            if (const auto rate = detail::get<float>(tag.map, tag::SAMPLE_RATE.shortKey())) {
+                sample_rate = rate;
+            }
+            if (const auto time = detail::get<std::uint64_t>(tag.map, tag::TRIGGER_TIME.shortKey())) {
+                const auto offset = detail::get<float>(tag.map, tag::TRIGGER_OFFSET.shortKey()).value_or(0.f);
+                time_reference    = std::pair{samples_seen + static_cast<std::size_t>(tag.index), static_cast<std::int64_t>(*time) + std::llround(static_cast<double>(offset) * 1e9)};
+            }
             if (const auto name = detail::get<std::string>(tag.map, tag::SIGNAL_NAME.shortKey())) {
                 signal_name = name;
             }
@@ -137,30 +877,446 @@ struct SignalEntry {
     auto operator<=>(const SignalEntry&) const noexcept = default;
 };
 
+struct DataSetSubscriber {
+    TimeDomainContext                     context;
+    std::string                           topic;  // identifies the subscription across updates of the subscription table
+    std::optional<std::uint64_t>          poller; // id of the DataSetPoller serving it, see DataSetPollerEntry::bindSubscribers()
+    SampleFormat                          sample_format       = SampleFormat::Float;
+    std::size_t                           pre_samples         = 0; // Trigger, Snapshot with multiple delays
+    std::size_t                           post_samples        = 0; // Trigger, Snapshot with multiple delays
+    std::size_t                           maximum_window_size = 0; // Multiplexed
+    std::size_t                           decimation_factor   = 1;
+    std::size_t                           max_batch_size      = 1;
+    Acquisition                           reply;            // reused between datasets to keep the capacity of the sample vectors
+    Acquisition                           batch;            // datasets of the current cycle not sent yet, if batching
+    std::vector<std::chrono::nanoseconds> snapshot_delays;  // Snapshot with multiple delays
+    std::vector<std::ptrdiff_t>           snapshot_offsets; // the delays in samples relative to the trigger, see setSnapshotWindow()
+
+    /// Converts the snapshot delays to sample offsets and the pre/post trigger window covering them
+    void setSnapshotWindow(float sampleRate) {
+        snapshot_offsets.clear();
+        for (const auto delay : snapshot_delays) {
+            snapshot_offsets.push_back(static_cast<std::ptrdiff_t>(std::llround(std::chrono::duration<double>(delay).count() * static_cast<double>(sampleRate))));
+        }
+        const auto [first, last] = std::ranges::minmax(snapshot_offsets);
+        pre_samples              = static_cast<std::size_t>(std::max(-first, std::ptrdiff_t{0}));
+        post_samples             = static_cast<std::size_t>(std::max(last, std::ptrdiff_t{0})) + 1;
+    }
+};
+
+/**
+ * Appends the reply for a dataset to a batched reply (TimeDomainContext::maxBatchSize): samples and errors are concatenated and the
+ * batch* fields list size and timestamps of each dataset, the status bits are combined, all other fields are those of the first
+ * dataset. Returns false without appending if the raw codes of the dataset are scaled differently than those already in the batch.
+ */
+inline bool appendToBatch(Acquisition& batch, Acquisition& segment) {
+    const auto segmentSize          = segment.channelValue.value().size() + segment.channelRawValueInt16.value().size() + segment.channelRawValueInt32.value().size(); // only one is used
+    const auto firstSampleTimeStamp = segment.channelFirstSampleTimeStamp.value();
+    const auto triggerTimeStamp     = segment.acqTriggerTimeStamp.value();
+    auto       append               = [](auto& to, const auto& from) { to.value().insert(to.value().end(), from.value().begin(), from.value().end()); };
+    if (batch.batchSegmentSize.value().empty()) {
+        batch = std::move(segment);
+    } else {
+        if (batch.channelRawScale.value() != segment.channelRawScale.value() || batch.channelRawOffset.value() != segment.channelRawOffset.value()) {
+            return false;
+        }
+        const auto batchSize = batch.channelValue.value().size() + batch.channelRawValueInt16.value().size() + batch.channelRawValueInt32.value().size();
+        if (batch.channelError.value().size() == batchSize && segment.channelError.value().size() == segmentSize) {
+            append(batch.channelError, segment.channelError);
+        } else {
+            batch.channelError.value().clear(); // errors are only sent if all datasets have them
+        }
+        append(batch.channelValue, segment.channelValue);
+        append(batch.channelRawValueInt16, segment.channelRawValueInt16);
+        append(batch.channelRawValueInt32, segment.channelRawValueInt32);
+        // Workaround for Annotated, see handleStreamingSubscription()
+        const typename decltype(batch.status)::R status = batch.status.value() | segment.status.value();
+        batch.status                                    = status;
+    }
+    batch.batchSegmentSize.value().push_back(static_cast<std::int32_t>(segmentSize));
+    batch.batchFirstSampleTimeStamp.value().push_back(firstSampleTimeStamp);
+    batch.batchTriggerTimeStamp.value().push_back(triggerTimeStamp);
+    return true;
+}
+
+/// Set by the wakeup callback of a sink when a trigger arrived
+using TriggerFlag = std::shared_ptr<std::atomic<bool>>;
+
+/**
+ * The wakeup callbacks registered with the sinks of a flow graph, see GnuRadioAcquisitionWorker::registerWakeupCallback(). DataSink
+ * callbacks cannot be unregistered, so there is one per poller key, and later registrations for the key get the flag of the first
+ * one.
+ */
+class WakeupCallbacks {
+    std::weak_ptr<detail::WakeupSignal> _signal;
+    std::mutex                          _mutex;
+    std::map<PollerKey, TriggerFlag>    _flags; // guarded by _mutex, pollers are serviced in parallel
+
+public:
+    explicit WakeupCallbacks(std::weak_ptr<detail::WakeupSignal> signal) : _signal(std::move(signal)) {}
+
+    /**
+     * Returns the flag set by the callback of the key, which also wakes up the signal. The first call for a key creates the
+     * callback and hands it to registerWithSink(callback).
+     */
+    template<typename TRegister>
+    TriggerFlag registerCallback(const PollerKey& key, TRegister&& registerWithSink) {
+        auto triggered = std::make_shared<std::atomic<bool>>(false);
+        {
+            std::lock_guard lock(_mutex);
+            if (const auto [it, inserted] = _flags.try_emplace(key, triggered); !inserted) {
+                return it->second;
+            }
+        }
+        registerWithSink([weakSignal = _signal, triggered](auto&&) {
+            if (auto signal = weakSignal.lock()) {
+                triggered->store(true);
+                signal->notify();
+            }
+        });
+        return triggered;
+    }
+};
+
+/// A dataset poller and the window it was created with
+struct DataSetPoller {
+    std::uint64_t    id = 0;
+    AnyDataSetPoller poller;
+    AnyDataSetPoller next_poller;                 // on the sink of the replacing flow graph while migrating
+    bool             migrating           = false; // the flow graph of poller is being replaced, see cutOver()
+    std::size_t      pre_samples         = 0;
+    std::size_t      post_samples        = 0;
+    std::size_t      maximum_window_size = 0;
+
+    /// Continues with the poller on the sink of the replacing flow graph, once the old one finished and was drained
+    void cutOver() noexcept {
+        poller    = std::exchange(next_poller, {});
+        migrating = false;
+    }
+
+    [[nodiscard]] bool covers(const DataSetSubscriber& subscriber) const noexcept { return subscriber.pre_samples <= pre_samples && subscriber.post_samples <= post_samples && subscriber.maximum_window_size <= maximum_window_size; }
+
+    /// Returns offset and length of the subscriber's window within a dataset of this poller
+    [[nodiscard]] std::pair<std::size_t, std::size_t> windowFor(AcquisitionMode mode, const DataSetSubscriber& subscriber, std::size_t dataSetSize) const noexcept {
+        if (mode == AcquisitionMode::Triggered) {
+            const auto offset = std::min(pre_samples - subscriber.pre_samples, dataSetSize);
+            return {offset, std::min(subscriber.pre_samples + subscriber.post_samples, dataSetSize - offset)};
+        }
+        if (mode == AcquisitionMode::Multiplexed) {
+            return {0UZ, std::min(subscriber.maximum_window_size, dataSetSize)};
+        }
+        return {0UZ, dataSetSize};
+    }
+};
+
+/**
+ * Triggered and multiplexed subscriptions that only differ in their window size (preSamples/postSamples/maximumWindowSize) share
+ * a poller created for the encompassing window. Each subscriber gets its own sub-range of the resulting datasets. A subscriber
+ * that does not fit the window gets a new, wider poller; the older pollers keep serving the subscribers bound to them until those
+ * unsubscribe, as the datasets already pending in their sinks are not repeated by the new poller. When the flow graph is replaced,
+ * each poller migrates to the sink of the new one like the streaming pollers do (see retire()).
+ */
 struct DataSetPollerEntry {
-    using SampleType = double;
-    std::shared_ptr<gr::basic::DataSink<SampleType>::DataSetPoller> poller;
-    bool                                                            in_use = false;
+    std::vector<DataSetPoller>            pollers; // oldest first, empty if no sink of the signal exists (yet)
+    std::uint64_t                         next_poller_id = 0;
+    std::map<std::string, std::uint64_t>  bound; // poller id by subscriber topic, kept across updates of the subscription table
+    bool                                  in_use = false;
+    bool                                  failed = false; // servicing threw, the entry is dropped and created anew
+    std::vector<DataSetSubscriber>        subscribers;    // subscribers of the current cycle
+    std::optional<float>                  sample_rate; // from the sink settings
+    PollerStatistics                      statistics;
+    TriggerFlag                           triggered;          // of the current flow graph, see GnuRadioAcquisitionWorker::registerWakeupCallback()
+    TriggerFlag                           retiring_triggered; // of the replaced flow graph, while pollers are migrating
+    std::chrono::steady_clock::time_point window_complete;    // when the post-trigger samples of the last trigger should have arrived
+
+    /**
+     * The flow graph of the pollers is being replaced: they keep serving their subscribers from the old sinks until those
+     * finished and were drained, and then continue with the pollers created for the same windows on the sinks of the new flow
+     * graph (see DataSetPoller::cutOver()), so no dataset of either flow graph is lost.
+     */
+    void retire() {
+        for (auto& poller : pollers) {
+            poller.migrating = true;
+        }
+        retiring_triggered = std::exchange(triggered, {});
+    }
+
+    /// After pollers cut over: drops those without a successor (no sink of the signal in the new flow graph), their subscribers get new ones
+    void completeCutOver() {
+        std::erase_if(pollers, [](const DataSetPoller& poller) { return poller.poller.index() == 0; });
+        bindSubscribers();
+        if (std::ranges::none_of(pollers, &DataSetPoller::migrating)) {
+            retiring_triggered = {};
+        }
+    }
+
+    /// Whether a wakeup callback of either flow graph fired since the last call
+    bool takeTriggered() noexcept {
+        const bool current  = triggered && triggered->exchange(false);
+        const bool retiring = retiring_triggered && retiring_triggered->exchange(false);
+        return current || retiring;
+    }
+
+    /**
+     * Binds each subscriber to the poller that served it before, if that one still exists and covers its window, or else to the
+     * newest poller if that covers it. Subscribers left unbound need a new poller, pollers left without subscribers are dropped.
+     */
+    void bindSubscribers() {
+        for (auto& subscriber : subscribers) {
+            subscriber.poller.reset();
+            if (const auto it = bound.find(subscriber.topic); it != bound.end()) {
+                const auto poller = std::ranges::find(pollers, it->second, &DataSetPoller::id);
+                if (poller != pollers.end() && poller->covers(subscriber)) {
+                    subscriber.poller = poller->id;
+                }
+            }
+            if (!subscriber.poller && !pollers.empty() && pollers.back().covers(subscriber)) {
+                subscriber.poller = pollers.back().id;
+            }
+        }
+        bound.clear();
+        for (const auto& subscriber : subscribers) {
+            if (subscriber.poller) {
+                bound[subscriber.topic] = *subscriber.poller;
+            }
+        }
+        std::erase_if(pollers, [this](const DataSetPoller& poller) { return std::ranges::none_of(subscribers, [&poller](const auto& subscriber) { return subscriber.poller == poller.id; }); });
+    }
+};
+
+/**
+ * The broker's subscriptions as last seen by the acquisition worker and direct handles to the pollers serving them. Subscriptions
+ * are only parsed and their pollers only looked up (or created) when the subscription set (compared in every cycle) or the signal
+ * info of the flow graph changes; a steady-state cycle just walks the poller handles. The handles point into the worker's poller
+ * maps, the table must be invalidated whenever entries are removed from those outside of the table update.
+ */
+template<typename TTopics>
+struct SubscriptionTable {
+    TTopics                                                         topics;
+    bool                                                            valid = false;
+    std::vector<std::pair<const PollerKey*, StreamingPollerEntry*>> streaming_pollers; // pollers with subscribers or retained history only
+    std::vector<std::pair<const PollerKey*, DataSetPollerEntry*>>   data_set_pollers;
+    HistoryRetention                                                history_retention; // applied when the table is rebuilt
+
+    void invalidate() noexcept {
+        valid = false;
+        streaming_pollers.clear();
+        data_set_pollers.clear();
+    }
+};
+
+template<typename T>
+using SinkPtr = gr::basic::DataSink<T>*;
+using AnySink = ForSinkSampleTypes<SinkPtr>;
+
+/**
+ * A flow graph executed by the acquisition worker: its scheduler, the message ports controlling it and the DataSinks with their
+ * signal info. When the flow graph is replaced, the new one is started right away while the old one is stopped and drained
+ * ("retiring"). Old and new sinks of a signal are registered with the DataSinkRegistry at the same time then, so pollers and
+ * wakeup callbacks are requested from the sinks of the flow graph itself.
+ */
+struct RunningFlowGraph {
+    using TScheduler = gr::scheduler::Simple<gr::scheduler::ExecutionPolicy::multiThreaded>;
+
+    std::map<std::string, SignalEntry>                              signal_entry_by_sink; // by unique name of the sink block
+    std::map<std::string, AnySink>                                  sinks;                // by unique name of the sink block, sinks of supported sample types only
+    std::map<std::string, std::pair<std::string, gr::property_map>> settings_by_block;    // by block name: unique name and initial settings
+    std::unique_ptr<TScheduler>                                     scheduler;
+    std::string                                                     scheduler_unique_name;
+    std::unique_ptr<MsgPortOut>                                     to_scheduler;
+    std::unique_ptr<MsgPortIn>                                      from_scheduler;
+    bool                                                            stop_requested = false;
+    bool                                                            stopped        = false;
+    mutable WakeupCallbacks                                         wakeup_callbacks; // see GnuRadioAcquisitionWorker::registerWakeupCallback()
+    std::jthread                                                    scheduler_thread; // declared last, so it is joined before the scheduler is destroyed
+
+    RunningFlowGraph(std::unique_ptr<gr::Graph> graph, std::weak_ptr<detail::WakeupSignal> wakeup) : wakeup_callbacks(std::move(wakeup)) {
+        for (auto& block : graph->blocks()) {
+            const auto uniqueName = std::string(block->uniqueName());
+            settings_by_block.emplace(std::string(block->name()), std::pair{uniqueName, block->settings().get()});
+            if (!block->typeName().starts_with("gr::basic::DataSink")) {
+                continue;
+            }
+            auto&      entry      = signal_entry_by_sink[uniqueName];
+            entry.name            = detail::getSetting<std::string>(*block, "signal_name").value_or("");
+            entry.unit            = detail::getSetting<std::string>(*block, "signal_unit").value_or("");
+            entry.sample_rate     = detail::getSetting<float>(*block, "sample_rate").value_or(1.f);
+            // the blocks keep their addresses when the graph is moved into the scheduler
+            if (auto sink = findPoller<AnySink>([&block]<typename T>() -> SinkPtr<T> {
+                    auto wrapper = dynamic_cast<BlockWrapper<basic::DataSink<T>>*>(block.get());
+                    return wrapper ? &wrapper->blockRef() : nullptr;
+                });
+                sink.index() != 0) {
+                sinks.emplace(uniqueName, sink);
+            }
+        }
+        scheduler             = std::make_unique<TScheduler>(std::move(*graph));
+        to_scheduler          = std::make_unique<MsgPortOut>();
+        from_scheduler        = std::make_unique<MsgPortIn>();
+        std::ignore           = to_scheduler->connect(scheduler->msgIn);
+        std::ignore           = scheduler->msgOut.connect(*from_scheduler);
+        scheduler_unique_name = scheduler->unique_name;
+        sendMessage<Subscribe>(*to_scheduler, scheduler_unique_name, block::property::kLifeCycleState, {}, "GnuRadioWorker");
+        sendMessage<Subscribe>(*to_scheduler, "", block::property::kSetting, {}, "GnuRadioWorker");
+        scheduler_thread = std::jthread([s = scheduler.get()] { s->runAndWait(); });
+    }
+
+    void requestStop() {
+        if (std::exchange(stop_requested, true)) {
+            return;
+        }
+        sendMessage<Set>(*to_scheduler, scheduler_unique_name, block::property::kLifeCycleState, {{"state", std::string(magic_enum::enum_name(lifecycle::State::REQUESTED_STOP))}}, "");
+    }
+
+    /**
+     * Sends changed block parameters (by block name, see detail::parameterChanges()) to the running blocks as settings, parsed as
+     * the type of the current setting. Returns false without sending anything if a block or setting is unknown or a value does
+     * not parse.
+     */
+    bool setParameters(const detail::ParameterChanges& changes) {
+        if (stop_requested) {
+            return false;
+        }
+        std::vector<std::pair<std::string, gr::property_map>> updates;
+        for (const auto& [blockName, parameters] : changes) {
+            const auto blockIt = settings_by_block.find(blockName);
+            if (blockIt == settings_by_block.end()) {
+                return false;
+            }
+            const auto& [uniqueName, settings] = blockIt->second;
+            gr::property_map update;
+            for (const auto& [key, value] : parameters) {
+                const auto settingIt = settings.find(key);
+                if (settingIt == settings.end()) {
+                    return false;
+                }
+                auto parsed = detail::parseSettingValue(settingIt->second, value);
+                if (!parsed) {
+                    return false;
+                }
+                update.emplace(key, std::move(*parsed));
+            }
+            updates.emplace_back(uniqueName, std::move(update));
+        }
+        for (auto& [uniqueName, update] : updates) {
+            sendMessage<Set>(*to_scheduler, uniqueName, block::property::kSetting, std::move(update), "");
+        }
+        return true;
+    }
+
+    /// Handles the messages from the scheduler, returns true if the signal info of a sink changed
+    bool processMessages() {
+        bool signalInfoChanged = false;
+        auto messages          = from_scheduler->streamReader().get(from_scheduler->streamReader().available());
+        for (const auto& message : messages) {
+            if (message.endpoint == block::property::kLifeCycleState) {
+                if (!message.data) {
+                    continue;
+                }
+                const auto state = detail::get<std::string>(*message.data, "state");
+                if (state == magic_enum::enum_name(lifecycle::State::STOPPED)) {
+                    stopped = true;
+                    continue;
+                }
+            } else if (message.endpoint == block::property::kSetting) {
+                const auto& settings = message.data;
+                if (!settings) {
+                    // e.g. a parameter edit the block rejected, see setParameters()
+                    fmt::println(std::cerr, "Could not apply settings to '{}': {}", message.serviceName, settings.error());
+                    continue;
+                }
+                auto sinkIt = signal_entry_by_sink.find(message.serviceName);
+                if (sinkIt == signal_entry_by_sink.end()) {
+                    continue;
+                }
+                auto& entry = sinkIt->second;
+
+                const auto signal_name = detail::get<std::string>(*settings, "signal_name");
+                const auto signal_unit = detail::get<std::string>(*settings, "signal_unit");
+                const auto sample_rate = detail::get<float>(*settings, "sample_rate");
+                if (signal_name && signal_name != entry.name) {
+                    entry.name        = *signal_name;
+                    signalInfoChanged = true;
+                }
+                if (signal_unit && signal_unit != entry.unit) {
+                    entry.unit        = *signal_unit;
+                    signalInfoChanged = true;
+                }
+                if (sample_rate && sample_rate != entry.sample_rate) {
+                    entry.sample_rate = *sample_rate;
+                    signalInfoChanged = true;
+                }
+            }
+        }
+
+        std::ignore = messages.consume(messages.size());
+        return signalInfoChanged;
+    }
+
+    [[nodiscard]] std::vector<SignalEntry> signalEntries() const {
+        std::vector<SignalEntry> entries;
+        entries.reserve(signal_entry_by_sink.size());
+        for (const auto& [_, entry] : signal_entry_by_sink) {
+            entries.push_back(entry);
+        }
+        return entries;
+    }
+
+    /// The sink of the given signal, empty if there is no such sink or the flow graph is stopping
+    [[nodiscard]] AnySink sink(std::string_view signalName) const {
+        const auto entryIt = std::ranges::find_if(signal_entry_by_sink, [signalName](const auto& item) { return item.second.name == signalName; });
+        if (stop_requested || entryIt == signal_entry_by_sink.end()) {
+            return {};
+        }
+        const auto sinkIt = sinks.find(entryIt->first);
+        return sinkIt != sinks.end() ? sinkIt->second : AnySink{};
+    }
+
+    /// Streaming poller on the sink of the given signal, empty if there is no such sink or the flow graph is stopping
+    [[nodiscard]] AnyStreamingPoller streamingPoller(std::string_view signalName, basic::BlockingMode blockingMode) const {
+        return std::visit(
+            [blockingMode]<typename TSink>(TSink sink) -> AnyStreamingPoller {
+                if constexpr (std::is_same_v<TSink, std::monostate>) {
+                    return {};
+                } else {
+                    return sink->getStreamingPoller(blockingMode);
+                }
+            },
+            sink(signalName));
+    }
 };
 
 template<units::basic_fixed_string serviceName, typename... Meta>
 class GnuRadioAcquisitionWorker : public Worker<serviceName, TimeDomainContext, Empty, Acquisition, Meta...> {
-    gr::PluginLoader*                             _plugin_loader;
-    std::jthread                                  _notifyThread;
-    std::unique_ptr<gr::Graph>                    _pending_flow_graph;
-    std::mutex                                    _flow_graph_mutex;
-    std::function<void(std::vector<SignalEntry>)> _updateSignalEntriesCallback;
+    gr::PluginLoader*                                _plugin_loader;
+    std::jthread                                     _notifyThread;
+    std::unique_ptr<gr::Graph>                       _pending_flow_graph;
+    detail::ParameterChanges                         _pending_parameters; // see setParameters()
+    std::function<std::unique_ptr<gr::Graph>()>      _pending_parameters_fallback;
+    HistoryRetention                                 _history_retention; // guarded by _flow_graph_mutex
+    std::mutex                                       _flow_graph_mutex;
+    std::function<void(std::vector<SignalEntry>)>    _updateSignalEntriesCallback;
+    std::shared_ptr<detail::WakeupSignal>            _wakeup = std::make_shared<detail::WakeupSignal>();
+    std::mutex                                       _current_flow_graph_mutex;
+    const RunningFlowGraph*                          _current_flow_graph = nullptr; // the notify thread's current one, see streamingPoller()
+    detail::ParallelFor                              _pollerThreads;
+    std::mutex                                       _telemetryMutex;
+    AcquisitionTelemetry                             _telemetry; // latest report, guarded by _telemetryMutex
+    std::function<void(const AcquisitionTelemetry&)> _telemetryCallback; // guarded by _telemetryMutex
+
+    static constexpr auto kTelemetryInterval    = 1s;
+    static constexpr auto kRetiringPollInterval = 10ms; // see finishRetiring, or the rate if that is shorter
 
 public:
     using super_t = Worker<serviceName, TimeDomainContext, Empty, Acquisition, Meta...>;
 
-    explicit GnuRadioAcquisitionWorker(opencmw::URI<opencmw::STRICT> brokerAddress, const opencmw::zmq::Context& context, gr::PluginLoader* pluginLoader, std::chrono::milliseconds rate, Settings settings = {}) : super_t(std::move(brokerAddress), {}, context, std::move(settings)), _plugin_loader(pluginLoader) {
+    explicit GnuRadioAcquisitionWorker(opencmw::URI<opencmw::STRICT> brokerAddress, const opencmw::zmq::Context& context, gr::PluginLoader* pluginLoader, std::chrono::milliseconds rate, std::size_t pollerThreadCount = 1, Settings settings = {}) : super_t(std::move(brokerAddress), {}, context, std::move(settings)), _plugin_loader(pluginLoader), _pollerThreads(pollerThreadCount) {
         // TODO would be useful if one can check if the external broker knows TimeDomainContext and throw an error if not
         init(rate);
     }
 
     template<typename BrokerType>
-    explicit GnuRadioAcquisitionWorker(BrokerType& broker, gr::PluginLoader* pluginLoader, std::chrono::milliseconds rate) : super_t(broker, {}), _plugin_loader(pluginLoader) {
+    explicit GnuRadioAcquisitionWorker(BrokerType& broker, gr::PluginLoader* pluginLoader, std::chrono::milliseconds rate, std::size_t pollerThreadCount = 1) : super_t(broker, {}), _plugin_loader(pluginLoader), _pollerThreads(pollerThreadCount) {
         // this makes sure the subscriptions are filtered correctly
         opencmw::query::registerTypes(TimeDomainContext(), broker);
         init(rate);
@@ -168,226 +1324,533 @@ public:
 
     ~GnuRadioAcquisitionWorker() {
         _notifyThread.request_stop();
+        _wakeup->notify();
         _notifyThread.join();
     }
 
     void setGraph(std::unique_ptr<gr::Graph> fg) {
-        std::lock_guard lg{_flow_graph_mutex};
-        _pending_flow_graph = std::move(fg);
+        {
+            std::lock_guard lg{_flow_graph_mutex};
+            _pending_flow_graph = std::move(fg);
+            // the new graph already has them
+            _pending_parameters.clear();
+            _pending_parameters_fallback = {};
+        }
+        _wakeup->notify();
+    }
+
+    /**
+     * Changes block parameters (by block name and parameter key, see detail::parameterChanges()) of the running flow graph, which
+     * is sent to the blocks as settings instead of restarting the flow graph. If they cannot be applied that way (no running flow
+     * graph, unknown block or setting, or a value that does not parse as the setting's type), the flow graph created by fallback
+     * replaces the running one.
+     */
+    void setParameters(const detail::ParameterChanges& changes, std::function<std::unique_ptr<gr::Graph>()> fallback) {
+        {
+            std::lock_guard lg{_flow_graph_mutex};
+            for (const auto& [blockName, parameters] : changes) {
+                for (const auto& [key, value] : parameters) {
+                    _pending_parameters[blockName][key] = value;
+                }
+            }
+            _pending_parameters_fallback = std::move(fallback);
+        }
+        _wakeup->notify();
+    }
+
+    /**
+     * Retains the most recent samples of every signal of the flow graph, up to the given duration and in total at most maxBytes of
+     * sample data, so new streaming subscriptions can ask for a backfill (TimeDomainContext::backfillDuration) which is sent before
+     * their live data. The history is fed by the signal's drop-oldest streaming poller, which is kept for that even while there
+     * are no subscribers. A duration of 0 (the default) disables the retention.
+     */
+    void setHistoryRetention(std::chrono::nanoseconds duration, std::size_t maxBytes) {
+        {
+            std::lock_guard lg{_flow_graph_mutex};
+            _history_retention = HistoryRetention{.duration = duration, .max_bytes = maxBytes};
+        }
+        _wakeup->notify();
     }
 
     void setUpdateSignalEntriesCallback(std::function<void(std::vector<SignalEntry>)> callback) { _updateSignalEntriesCallback = std::move(callback); }
 
+    /**
+     * Streaming poller on the sink of the given signal in the current flow graph, for other workers serving the flow graph's
+     * signals. Unlike a lookup in the DataSinkRegistry by signal name, this never returns the sink of a flow graph that is being
+     * replaced. Empty if there is no such sink.
+     */
+    [[nodiscard]] AnyStreamingPoller streamingPoller(std::string_view signalName, basic::BlockingMode blockingMode) {
+        std::lock_guard lock(_current_flow_graph_mutex);
+        return _current_flow_graph ? _current_flow_graph->streamingPoller(signalName, blockingMode) : AnyStreamingPoller{};
+    }
+
+    /// The latest telemetry report, updated every kTelemetryInterval
+    [[nodiscard]] AcquisitionTelemetry telemetry() {
+        std::lock_guard lock(_telemetryMutex);
+        return _telemetry;
+    }
+
+    /// Called from the notify thread with every new telemetry report
+    void setTelemetryCallback(std::function<void(const AcquisitionTelemetry&)> callback) {
+        std::lock_guard lock(_telemetryMutex);
+        _telemetryCallback = std::move(callback);
+    }
+
 private:
     void init(std::chrono::milliseconds rate) {
-        // TODO instead of a notify thread with polling, we could also use callbacks. This would require
-        // the ability to unregister callbacks though (RAII callback "handles" using shared_ptr/weak_ptr like it works for pollers??)
+        // The notify thread still drains the pollers, but instead of sleeping for a fixed interval it is woken up by sink callbacks
+        // registered for the dataset pollers (see registerWakeupCallback()), on flow graph changes and on shutdown. Only the
+        // dataset modes are woken up that way, 'rate' is the upper bound for the wait and what streaming subscriptions are served with.
         _notifyThread = std::jthread([this, rate](const std::stop_token& stoken) {
-            auto update = std::chrono::system_clock::now();
-            // TODO: current load_grc creates Foo<double> types no matter what the original type was
-            // when supporting more types, we need some type erasure here
+            // pollers are type-erased over the sink sample types (ForSinkSampleTypes), note that load_grc currently only creates
+            // Foo<double> types, graphs with other sample types need to be created programmatically
             std::map<PollerKey, StreamingPollerEntry> streamingPollers;
             std::map<PollerKey, DataSetPollerEntry>   dataSetPollers;
-            std::jthread                              schedulerThread;
-            std::string                               schedulerUniqueName;
-            std::map<std::string, SignalEntry>        signalEntryBySink;
-            std::unique_ptr<MsgPortOut>               toScheduler;
-            std::unique_ptr<MsgPortIn>                fromScheduler;
+            std::unique_ptr<RunningFlowGraph>         current;  // new pollers are created for the sinks of this one
+            std::unique_ptr<RunningFlowGraph>         retiring; // replaced by current, drained until it stopped
+            SubscriptionTable<std::remove_cvref_t<decltype(this->activeSubscriptions())>> subscriptionTable;
+            CycleStatistics                                                               cycleStatistics;
+            auto                                                                          lastTelemetryReport = std::chrono::steady_clock::now();
+
+            // other threads access the current flow graph through streamingPoller(), until it is unpublished again
+            auto publishCurrent = [this, &current] {
+                std::lock_guard lock(_current_flow_graph_mutex);
+                _current_flow_graph = current.get();
+            };
+            auto publishSignalEntries = [this, &current] {
+                if (_updateSignalEntriesCallback) {
+                    _updateSignalEntriesCallback(current ? current->signalEntries() : std::vector<SignalEntry>{});
+                }
+            };
 
-            bool finished = false;
+            // A replaced flow graph is stopped while its successor already runs. The streaming pollers keep serving the old sinks
+            // until those finished and were drained, and then continue with the pollers on the new sinks of the same signal,
+            // created when the successor was started (see StreamingPollerEntry::cutOver()). Subscribers keep their state, so the
+            // clients see one continuous stream. Dataset pollers migrate the same way (see DataSetPollerEntry::retire()).
+            auto retire = [&] {
+                for (auto& [_, pollerEntry] : streamingPollers) {
+                    pollerEntry.migrating = true;
+                }
+                for (auto& [_, pollerEntry] : dataSetPollers) {
+                    pollerEntry.retire();
+                }
+                subscriptionTable.invalidate();
+                retiring = std::move(current);
+                publishCurrent();
+                retiring->requestStop();
+            };
+            auto completeCutOver = [&] {
+                const auto migrating = std::ranges::any_of(streamingPollers, [](const auto& item) { return item.second.migrating; }) //
+                                    || std::ranges::any_of(dataSetPollers, [](const auto& item) { return std::ranges::any_of(item.second.pollers, &DataSetPoller::migrating); });
+                if (!retiring || !retiring->stopped || migrating) {
+                    return false;
+                }
+                retiring.reset(); // joins the scheduler thread
+                return true;
+            };
+            auto finishRetiring = [&] {
+                bool woken = false;
+                while (retiring && !completeCutOver()) {
+                    std::ignore = retiring->processMessages();
+                    handleSubscriptions(streamingPollers, dataSetPollers, current.get(), subscriptionTable);
+                    // nothing signals that the old flow graph stopped, poll for it without spinning
+                    woken = _wakeup->waitUntil(std::chrono::steady_clock::now() + std::min<std::chrono::nanoseconds>(rate, kRetiringPollInterval)) || woken;
+                }
+                if (woken) {
+                    _wakeup->notify(); // e.g. a new flow graph, for the main loop
+                }
+            };
 
-            while (!finished) {
-                const auto aboutToFinish    = stoken.stop_requested();
-                auto       pendingFlowGraph = [this]() {
+            while (true) {
+                const auto cycleStart    = std::chrono::steady_clock::now();
+                const auto aboutToFinish = stoken.stop_requested();
+                auto [pendingFlowGraph, pendingParameters, pendingParametersFallback, historyRetention] = [this]() {
                     std::lock_guard lg{_flow_graph_mutex};
-                    return std::exchange(_pending_flow_graph, {});
+                    return std::tuple{std::exchange(_pending_flow_graph, {}), std::exchange(_pending_parameters, {}), std::exchange(_pending_parameters_fallback, {}), _history_retention};
                 }();
-                const auto hasScheduler      = schedulerThread.joinable();
-                const bool stopScheduler     = hasScheduler && (aboutToFinish || pendingFlowGraph);
-                bool       schedulerFinished = false;
-
-                if (stopScheduler) {
-                    sendMessage<Set>(*toScheduler, schedulerUniqueName, block::property::kLifeCycleState, {{"state", std::string(magic_enum::enum_name(lifecycle::State::REQUESTED_STOP))}}, "");
-                }
-
-                if (hasScheduler) {
-                    bool signalInfoChanged = false;
-                    auto messages          = fromScheduler->streamReader().get(fromScheduler->streamReader().available());
-                    for (const auto& message : messages) {
-                        if (message.endpoint == block::property::kLifeCycleState) {
-                            if (!message.data) {
-                                continue;
-                            }
-                            const auto state = detail::get<std::string>(*message.data, "state");
-                            if (state == magic_enum::enum_name(lifecycle::State::STOPPED)) {
-                                schedulerFinished = true;
-                                continue;
-                            }
-                        } else if (message.endpoint == block::property::kSetting) {
-                            auto sinkIt = signalEntryBySink.find(message.serviceName);
-                            if (sinkIt == signalEntryBySink.end()) {
-                                continue;
-                            }
-                            const auto& settings = message.data;
-                            if (!settings) {
-                                continue;
-                            }
-                            auto& entry = sinkIt->second;
-
-                            const auto signal_name = detail::get<std::string>(*settings, "signal_name");
-                            const auto signal_unit = detail::get<std::string>(*settings, "signal_unit");
-                            const auto sample_rate = detail::get<float>(*settings, "sample_rate");
-                            if (signal_name && signal_name != entry.name) {
-                                entry.name        = *signal_name;
-                                signalInfoChanged = true;
-                            }
-                            if (signal_unit && signal_unit != entry.unit) {
-                                entry.unit        = *signal_unit;
-                                signalInfoChanged = true;
-                            }
-                            if (sample_rate && sample_rate != entry.sample_rate) {
-                                entry.sample_rate = *sample_rate;
-                                signalInfoChanged = true;
-                            }
-                        }
+                if (historyRetention != subscriptionTable.history_retention) {
+                    subscriptionTable.history_retention = historyRetention;
+                    subscriptionTable.invalidate();
+                }
+
+                if (current && (aboutToFinish || pendingFlowGraph)) {
+                    finishRetiring(); // the flow graph was replaced before the previous one stopped
+                    retire();
+                    if (aboutToFinish) {
+                        publishSignalEntries();
                     }
+                }
 
-                    std::ignore = messages.consume(messages.size());
+                if (pendingFlowGraph && !aboutToFinish) {
+                    current = std::make_unique<RunningFlowGraph>(std::move(pendingFlowGraph), _wakeup);
+                    publishCurrent();
+                    subscriptionTable.invalidate();
+                    publishSignalEntries();
+                }
 
-                    if (signalInfoChanged && _updateSignalEntriesCallback) {
-                        std::vector<SignalEntry> entries;
-                        entries.reserve(signalEntryBySink.size());
-                        for (const auto& [_, entry] : signalEntryBySink) {
-                            entries.push_back(entry);
+                if (pendingParametersFallback && !aboutToFinish && !(current && current->setParameters(pendingParameters))) {
+                    // replace the whole flow graph instead, in the next cycle
+                    try {
+                        auto            graph = pendingParametersFallback();
+                        std::lock_guard lg{_flow_graph_mutex};
+                        if (!_pending_flow_graph) {
+                            _pending_flow_graph = std::move(graph);
                         }
-                        _updateSignalEntriesCallback(std::move(entries));
+                    } catch (const std::string& e) {
+                        fmt::println(std::cerr, "Could not load flow graph: {}", e);
+                    } catch (const std::exception& e) {
+                        fmt::println(std::cerr, "Could not load flow graph: {}", e.what());
                     }
+                    _wakeup->notify();
+                }
 
-                    bool pollersFinished = true;
-                    do {
-                        pollersFinished = true;
-                        for (auto& [_, pollerEntry] : streamingPollers) {
-                            pollerEntry.in_use = false;
-                        }
-                        for (auto& [_, pollerEntry] : dataSetPollers) {
-                            pollerEntry.in_use = false;
-                        }
-                        pollersFinished = handleSubscriptions(streamingPollers, dataSetPollers);
-                        // drop pollers of old subscriptions to avoid the sinks from blocking
-                        std::erase_if(streamingPollers, [](const auto& item) { return !item.second.in_use; });
-                        std::erase_if(dataSetPollers, [](const auto& item) { return !item.second.in_use; });
-                    } while (stopScheduler && !pollersFinished);
+                bool signalInfoChanged = false;
+                if (current) {
+                    std::lock_guard lock(_current_flow_graph_mutex); // the signal names are looked up by streamingPoller()
+                    signalInfoChanged = current->processMessages();
+                }
+                if (signalInfoChanged) {
+                    subscriptionTable.invalidate(); // sample rate fallbacks and sinks of the pollers
+                    publishSignalEntries();
+                }
+                if (retiring) {
+                    std::ignore = retiring->processMessages();
                 }
 
-                if (stopScheduler || schedulerFinished) {
-                    if (_updateSignalEntriesCallback) {
-                        _updateSignalEntriesCallback({});
-                    }
-                    signalEntryBySink.clear();
+                if (current || retiring) {
+                    handleSubscriptions(streamingPollers, dataSetPollers, current.get(), subscriptionTable);
+                }
+                std::ignore = completeCutOver();
+
+                if (current && current->stopped) {
+                    // the flow graph finished by itself, the pollers were drained above
+                    finishRetiring();
+                    current.reset();
+                    publishCurrent();
+                    subscriptionTable.invalidate();
                     streamingPollers.clear();
                     dataSetPollers.clear();
-                    fromScheduler.reset();
-                    toScheduler.reset();
-                    schedulerUniqueName.clear();
-                    schedulerThread.join();
+                    publishSignalEntries();
                 }
 
                 if (aboutToFinish) {
-                    finished = true;
-                    continue;
+                    finishRetiring();
+                    break;
                 }
 
-                if (pendingFlowGraph) {
-                    pendingFlowGraph->forEachBlock([&signalEntryBySink](const auto& block) {
-                        if (block.typeName().starts_with("gr::basic::DataSink")) {
-                            auto& entry       = signalEntryBySink[std::string(block.uniqueName())];
-                            entry.name        = detail::getSetting<std::string>(block, "signal_name").value_or("");
-                            entry.unit        = detail::getSetting<std::string>(block, "signal_unit").value_or("");
-                            entry.sample_rate = detail::getSetting<float>(block, "sample_rate").value_or(1.f);
-                        }
-                    });
-                    if (_updateSignalEntriesCallback) {
-                        std::vector<SignalEntry> entries;
-                        entries.reserve(signalEntryBySink.size());
-                        for (const auto& [_, entry] : signalEntryBySink) {
-                            entries.push_back(entry);
-                        }
-                        _updateSignalEntriesCallback(std::move(entries));
+                const auto cycleEnd = std::chrono::steady_clock::now();
+                cycleStatistics.record(cycleEnd - cycleStart, rate);
+                if (cycleEnd - lastTelemetryReport >= kTelemetryInterval) {
+                    publishTelemetry(streamingPollers, dataSetPollers, subscriptionTable, cycleStatistics, cycleEnd - lastTelemetryReport);
+                    lastTelemetryReport = cycleEnd;
+                }
+
+                // triggers wake up the thread right away, their post-trigger samples may need another wakeup before the next cycle
+                auto deadline = std::chrono::steady_clock::now() + rate;
+                for (const auto& [_, pollerEntry] : subscriptionTable.data_set_pollers) {
+                    if (pollerEntry->window_complete > cycleEnd) {
+                        deadline = std::min(deadline, pollerEntry->window_complete);
                     }
-                    auto sched          = std::make_unique<scheduler::Simple<scheduler::ExecutionPolicy::multiThreaded>>(std::move(*pendingFlowGraph));
-                    toScheduler         = std::make_unique<MsgPortOut>();
-                    fromScheduler       = std::make_unique<MsgPortIn>();
-                    std::ignore         = toScheduler->connect(sched->msgIn);
-                    std::ignore         = sched->msgOut.connect(*fromScheduler);
-                    schedulerUniqueName = sched->unique_name;
-                    sendMessage<Subscribe>(*toScheduler, schedulerUniqueName, block::property::kLifeCycleState, {}, "GnuRadioWorker");
-                    sendMessage<Subscribe>(*toScheduler, "", block::property::kSetting, {}, "GnuRadioWorker");
-                    schedulerThread = std::jthread([s = std::move(sched)] { s->runAndWait(); });
                 }
+                std::ignore = _wakeup->waitUntil(deadline);
+            }
+        });
+    }
 
-                const auto next_update = update + rate;
-                const auto now         = std::chrono::system_clock::now();
-                if (now < next_update) {
-                    std::this_thread::sleep_for(next_update - now);
+    template<typename TTopics>
+    void publishTelemetry(std::map<PollerKey, StreamingPollerEntry>& streamingPollers, std::map<PollerKey, DataSetPollerEntry>& dataSetPollers, const SubscriptionTable<TTopics>& table, CycleStatistics& cycleStatistics, std::chrono::nanoseconds interval) {
+        using std::chrono::duration;
+        AcquisitionTelemetry report;
+        const double         seconds = duration<double>(interval).count();
+        // Workaround for Annotated, see handleStreamingSubscription()
+        const typename decltype(report.timestamp)::R           timestamp           = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        const typename decltype(report.reportInterval)::R      reportInterval      = static_cast<float>(seconds);
+        const typename decltype(report.activeSubscriptions)::R activeSubscriptions = static_cast<std::int32_t>(table.topics.size());
+        const typename decltype(report.cycleDurationMean)::R   cycleDurationMean   = cycleStatistics.cycles > 0 ? duration<float>(cycleStatistics.total).count() / static_cast<float>(cycleStatistics.cycles) : 0.0f;
+        const typename decltype(report.cycleDurationMax)::R    cycleDurationMax    = duration<float>(cycleStatistics.longest).count();
+        const typename decltype(report.cycleOverruns)::R       cycleOverruns       = static_cast<std::int64_t>(cycleStatistics.overruns);
+        report.timestamp                                                           = timestamp;
+        report.reportInterval                                                      = reportInterval;
+        report.activeSubscriptions                                                 = activeSubscriptions;
+        report.cycleDurationMean                                                   = cycleDurationMean;
+        report.cycleDurationMax                                                    = cycleDurationMax;
+        report.cycleOverruns                                                       = cycleOverruns;
+        cycleStatistics.resetInterval();
+        for (const auto bound : PollerStatistics::kLatencyBinBounds) {
+            report.latencyBinBounds.value().push_back(duration<float>(bound).count());
+        }
+
+        auto addPoller = [&report, seconds](const PollerKey& key, PollerStatistics& statistics, std::size_t subscriptions, std::size_t queuedSamples) {
+            report.pollerSignalName.value().push_back(key.signal_name);
+            report.pollerAcquisitionMode.value().emplace_back(acquisitionModeName(key.mode));
+            report.pollerSubscriptions.value().push_back(static_cast<std::int32_t>(subscriptions));
+            report.pollerSampleRate.value().push_back(static_cast<float>(static_cast<double>(statistics.samples) / seconds));
+            report.pollerNotificationRate.value().push_back(static_cast<float>(static_cast<double>(statistics.notifications) / seconds));
+            report.pollerBytesSerialised.value().push_back(static_cast<std::int64_t>(statistics.bytes_serialised));
+            report.pollerQueuedSamples.value().push_back(static_cast<std::int64_t>(queuedSamples));
+            for (const auto count : statistics.latency_histogram) {
+                report.pollerLatencyHistogram.value().push_back(static_cast<std::int64_t>(count));
+            }
+            statistics.resetInterval();
+        };
+        for (auto& [key, pollerEntry] : streamingPollers) {
+            std::size_t queued = 0;
+            for (const auto& [_, subscriber] : pollerEntry.subscribers) {
+                queued += subscriber.pendingSize();
+            }
+            addPoller(key, pollerEntry.statistics, pollerEntry.subscribers.size(), queued);
+        }
+        for (auto& [key, pollerEntry] : dataSetPollers) {
+            addPoller(key, pollerEntry.statistics, pollerEntry.subscribers.size(), 0UZ); // datasets are queued in the sink only
+        }
+
+        std::lock_guard lock(_telemetryMutex);
+        _telemetry = std::move(report);
+        if (_telemetryCallback) {
+            _telemetryCallback(_telemetry);
+        }
+    }
+
+    template<typename TTopics>
+    void handleSubscriptions(std::map<PollerKey, StreamingPollerEntry>& streamingPollers, std::map<PollerKey, DataSetPollerEntry>& dataSetPollers, const RunningFlowGraph* flowGraph, SubscriptionTable<TTopics>& table) {
+        if (auto subscriptions = super_t::activeSubscriptions(); !table.valid || subscriptions != table.topics) {
+            table.topics = std::move(subscriptions);
+            updateSubscriptionTable(streamingPollers, dataSetPollers, flowGraph, table);
+        }
+
+        // Each poller, with all of its subscribers, is serviced by one of the poller threads, which also serialises and sends the
+        // replies. Poller entries do not share state, so the table only needs to provide the handles.
+        const auto        nStreaming = table.streaming_pollers.size();
+        std::atomic<bool> anyFailed  = false;
+        _pollerThreads.run(nStreaming + table.data_set_pollers.size(), [this, &table, nStreaming, flowGraph, &anyFailed](std::size_t i) {
+            const auto& key    = i < nStreaming ? *table.streaming_pollers[i].first : *table.data_set_pollers[i - nStreaming].first;
+            bool&       failed = i < nStreaming ? table.streaming_pollers[i].second->failed : table.data_set_pollers[i - nStreaming].second->failed;
+            try {
+                if (i < nStreaming) {
+                    handleStreamingSubscription(key, *table.streaming_pollers[i].second);
+                } else {
+                    handleDataSetSubscription(key, *table.data_set_pollers[i - nStreaming].second, flowGraph);
                 }
-                update = next_update;
+            } catch (const std::exception& e) {
+                fmt::println(std::cerr, "Could not serve the subscriptions of signal '{}': {}", key.signal_name, e.what());
+                failed    = true;
+                anyFailed = true;
+            } catch (...) {
+                fmt::println(std::cerr, "Could not serve the subscriptions of signal '{}': unknown error", key.signal_name);
+                failed    = true;
+                anyFailed = true;
             }
         });
+        // failed entries are dropped, which releases their sinks; the table update creates new ones for their subscriptions
+        if (anyFailed) {
+            table.invalidate();
+            std::erase_if(streamingPollers, [](const auto& item) { return item.second.failed; });
+            std::erase_if(dataSetPollers, [](const auto& item) { return item.second.failed; });
+        }
     }
 
-    bool handleSubscriptions(std::map<PollerKey, StreamingPollerEntry>& streamingPollers, std::map<PollerKey, DataSetPollerEntry>& dataSetPollers) {
-        bool pollersFinished = true;
-        for (const auto& subscription : super_t::activeSubscriptions()) {
+    template<typename TTopics>
+    void updateSubscriptionTable(std::map<PollerKey, StreamingPollerEntry>& streamingPollers, std::map<PollerKey, DataSetPollerEntry>& dataSetPollers, const RunningFlowGraph* flowGraph, SubscriptionTable<TTopics>& table) {
+        table.invalidate();
+        // sample rate from the sink settings, used if the sample data does not carry a sample_rate tag
+        auto sinkSampleRate = [flowGraph](std::string_view signalName) -> std::optional<float> {
+            if (!flowGraph) {
+                return {};
+            }
+            const auto it = std::ranges::find_if(flowGraph->signal_entry_by_sink, [signalName](const auto& item) { return item.second.name == signalName; });
+            return it != flowGraph->signal_entry_by_sink.end() ? std::optional(it->second.sample_rate) : std::nullopt;
+        };
+        for (auto& [_, pollerEntry] : streamingPollers) {
+            pollerEntry.in_use = false;
+            for (auto& subscriberItem : pollerEntry.subscribers) {
+                subscriberItem.second.in_use = false;
+            }
+        }
+        for (auto& [_, pollerEntry] : dataSetPollers) {
+            pollerEntry.in_use = false;
+            pollerEntry.subscribers.clear();
+        }
+        std::vector<std::pair<const StreamingSubscriber*, std::string>> backfills; // new subscribers and their signal
+        for (const auto& subscription : table.topics) {
             const auto filterIn = opencmw::query::deserialise<TimeDomainContext>(subscription.params());
             try {
                 const auto acquisitionMode = parseAcquisitionMode(filterIn.acquisitionModeFilter);
+                const auto sampleFormat    = parseSampleFormat(filterIn.sampleFormat);
+                const auto overflowPolicy  = parseOverflowPolicy(filterIn.overflowPolicy);
                 for (std::string_view signalName : filterIn.channelNameFilter | std::ranges::views::split(',') | std::ranges::views::transform([](const auto&& r) { return std::string_view{&*r.begin(), std::ranges::distance(r)}; })) {
                     if (acquisitionMode == AcquisitionMode::Continuous) {
-                        if (!handleStreamingSubscription(streamingPollers, filterIn, signalName)) {
-                            pollersFinished = false;
+                        auto& pollerEntry              = getStreamingPoller(streamingPollers, signalName, overflowPolicy, flowGraph)->second;
+                        auto [subscriberIt, isNew]     = pollerEntry.subscribers.try_emplace(subscription.toZmqTopic());
+                        auto& subscriber               = subscriberIt->second;
+                        subscriber.context             = filterIn;
+                        subscriber.sample_format       = sampleFormat;
+                        subscriber.overflow_policy     = overflowPolicy;
+                        subscriber.max_queued          = static_cast<std::size_t>(std::max(filterIn.maxQueuedSamples, 2));
+                        subscriber.min_update_interval = filterIn.maxClientUpdateFrequencyFilter > 0 ? std::chrono::nanoseconds(1s) / filterIn.maxClientUpdateFrequencyFilter : std::chrono::nanoseconds(0);
+                        subscriber.decimator.factor    = static_cast<std::size_t>(std::max(filterIn.decimationFactor, 1));
+                        subscriber.in_use              = true;
+                        if (isNew && filterIn.backfillDuration > 0) {
+                            backfills.emplace_back(&subscriber, std::string(signalName));
                         }
                     } else {
-                        if (!handleDataSetSubscription(dataSetPollers, filterIn, acquisitionMode, signalName)) {
-                            pollersFinished = false;
-                        }
+                        addDataSetSubscriber(dataSetPollers, subscription.toZmqTopic(), filterIn, acquisitionMode, sampleFormat, signalName);
                     }
                 }
             } catch (const std::exception& e) {
                 fmt::println(std::cerr, "Could not handle subscription {}: {}", subscription.toZmqTopic(), e.what());
             }
         }
-        return pollersFinished;
+        // the drop-oldest pollers of all signals are kept while retaining history, each with its share of the memory budget
+        const auto& retention = table.history_retention;
+        for (auto& [_, pollerEntry] : streamingPollers) {
+            pollerEntry.retain_history = false;
+        }
+        if (flowGraph && retention.duration > std::chrono::nanoseconds(0) && !flowGraph->signal_entry_by_sink.empty()) {
+            for (const auto& [_, signal] : flowGraph->signal_entry_by_sink) {
+                auto& pollerEntry             = getStreamingPoller(streamingPollers, signal.name, OverflowPolicy::DropOldest, flowGraph)->second;
+                pollerEntry.retain_history    = true;
+                pollerEntry.history.duration  = retention.duration;
+                pollerEntry.history.max_bytes = retention.max_bytes / flowGraph->signal_entry_by_sink.size();
+            }
+        }
+        // drop pollers of old subscriptions to avoid the sinks from blocking
+        std::erase_if(streamingPollers, [](const auto& item) { return !item.second.in_use; });
+        std::erase_if(dataSetPollers, [](const auto& item) { return !item.second.in_use; });
+
+        for (auto& [key, pollerEntry] : streamingPollers) {
+            std::erase_if(pollerEntry.subscribers, [](const auto& item) { return !item.second.in_use; });
+            // the sink did not exist (yet) when the poller entry was created, or belongs to a flow graph that is being replaced
+            if (pollerEntry.migrating && pollerEntry.next_poller.index() == 0) {
+                pollerEntry.next_poller = findStreamingPoller(key, flowGraph);
+            } else if (!pollerEntry.migrating && pollerEntry.poller.index() == 0) {
+                pollerEntry.poller = findStreamingPoller(key, flowGraph);
+            }
+            if (!pollerEntry.sample_rate) {
+                pollerEntry.sample_rate = sinkSampleRate(key.signal_name);
+            }
+            if (!pollerEntry.retain_history) {
+                pollerEntry.history.clear();
+            }
+            if (!pollerEntry.subscribers.empty() || pollerEntry.retain_history) {
+                table.streaming_pollers.emplace_back(&key, &pollerEntry);
+            }
+        }
+        for (const auto& [subscriber, signalName] : backfills) {
+            sendBackfill(streamingPollers, *subscriber, signalName);
+        }
+        for (auto& [key, pollerEntry] : dataSetPollers) {
+            pollerEntry.sample_rate = sinkSampleRate(key.signal_name);
+            if (key.snapshot_window) {
+                // the delays are converted to sample offsets with the sample rate of the sink
+                if (!pollerEntry.sample_rate || *pollerEntry.sample_rate <= 0.f) {
+                    fmt::println(std::cerr, "Snapshots at multiple delays need the sample rate of '{}', which is unknown", key.signal_name);
+                    pollerEntry.subscribers.clear();
+                }
+                for (auto& subscriber : pollerEntry.subscribers) {
+                    subscriber.setSnapshotWindow(*pollerEntry.sample_rate);
+                }
+            }
+            pollerEntry.bindSubscribers();
+            // pollers of a flow graph that is being replaced get their successors on the sinks of the new one
+            for (auto& dataSetPoller : pollerEntry.pollers) {
+                if (dataSetPoller.migrating && dataSetPoller.next_poller.index() == 0) {
+                    dataSetPoller.next_poller = findDataSetPoller(key, dataSetPoller, flowGraph);
+                    if (dataSetPoller.next_poller.index() != 0 && !pollerEntry.triggered) {
+                        pollerEntry.triggered = registerWakeupCallback(key, *flowGraph);
+                    }
+                }
+            }
+            if (!pollerEntry.subscribers.empty()) {
+                table.data_set_pollers.emplace_back(&key, &pollerEntry);
+            }
+        }
+        table.valid = true;
     }
 
-    auto getStreamingPoller(std::map<PollerKey, StreamingPollerEntry>& pollers, std::string_view signalName) {
-        const auto key = PollerKey{.mode = AcquisitionMode::Continuous, .signal_name = std::string(signalName)};
+    auto getStreamingPoller(std::map<PollerKey, StreamingPollerEntry>& pollers, std::string_view signalName, OverflowPolicy overflowPolicy, const RunningFlowGraph* flowGraph) {
+        const auto key = PollerKey{.mode = AcquisitionMode::Continuous, .signal_name = std::string(signalName), .overflow_policy = overflowPolicy};
 
         auto pollerIt = pollers.find(key);
         if (pollerIt == pollers.end()) {
-            const auto query = basic::DataSinkQuery::signalName(signalName);
-            pollerIt         = pollers.emplace(key, basic::DataSinkRegistry::instance().getStreamingPoller<double>(query)).first;
+            pollerIt = pollers.emplace(key, findStreamingPoller(key, flowGraph)).first;
         }
+        pollerIt->second.in_use = true;
         return pollerIt;
     }
 
-    bool handleStreamingSubscription(std::map<PollerKey, StreamingPollerEntry>& pollers, const TimeDomainContext& context, std::string_view signalName) {
-        auto pollerIt = getStreamingPoller(pollers, signalName);
-        if (pollerIt == pollers.end()) { // flushing, do not create new pollers
-            return true;
+    static AnyStreamingPoller findStreamingPoller(const PollerKey& key, const RunningFlowGraph* flowGraph) {
+        const auto blocking = key.overflow_policy == OverflowPolicy::Lossless ? basic::BlockingMode::Blocking : basic::BlockingMode::NonBlocking;
+        return flowGraph ? flowGraph->streamingPoller(key.signal_name, blocking) : AnyStreamingPoller{};
+    }
+
+    /**
+     * Sends the retained history of the signal (at most the subscription's backfillDuration) to a new subscriber, as one update
+     * before its live data. The history is that of the signal's drop-oldest poller: for drop-oldest subscriptions it ends exactly
+     * where their live data starts, lossless ones get their live data from a poller of their own, which may overlap or leave a
+     * gap to the history.
+     */
+    void sendBackfill(const std::map<PollerKey, StreamingPollerEntry>& streamingPollers, const StreamingSubscriber& subscriber, std::string_view signalName) {
+        const auto historyIt = streamingPollers.find(PollerKey{.mode = AcquisitionMode::Continuous, .signal_name = std::string(signalName), .overflow_policy = OverflowPolicy::DropOldest});
+        if (historyIt == streamingPollers.end() || !historyIt->second.retain_history || historyIt->second.history.size() == 0) {
+            return;
         }
+        const auto& [key, pollerEntry] = *historyIt;
+        const auto  maxSamples         = pollerEntry.sample_rate && *pollerEntry.sample_rate > 0.f ? static_cast<std::size_t>(std::ceil(std::chrono::duration<double>(std::chrono::nanoseconds(subscriber.context.backfillDuration)).count() * static_cast<double>(*pollerEntry.sample_rate))) : std::numeric_limits<std::size_t>::max();
 
-        const auto& key         = pollerIt->first;
-        auto&       pollerEntry = pollerIt->second;
+        Acquisition reply;
+        reply.acqTriggerName = "STREAMING";
+        reply.channelName    = pollerEntry.signal_name.value_or(key.signal_name);
+        reply.channelUnit    = pollerEntry.signal_unit.value_or("N/A");
+        // Workaround for Annotated, see handleStreamingSubscription()
+        const typename decltype(reply.channelRangeMin)::R rangeMin = pollerEntry.signal_min ? static_cast<float>(*pollerEntry.signal_min) : std::numeric_limits<float>::lowest();
+        const typename decltype(reply.channelRangeMax)::R rangeMax = pollerEntry.signal_max ? static_cast<float>(*pollerEntry.signal_max) : std::numeric_limits<float>::max();
+        reply.channelRangeMin                                      = rangeMin;
+        reply.channelRangeMax                                      = rangeMax;
+        std::visit(
+            [&]<typename THistory>(const THistory&) {
+                if constexpr (!std::is_same_v<THistory, std::monostate>) {
+                    using T = typename THistory::value_type;
+                    std::vector<T> samples;
+                    const auto     firstSample = pollerEntry.history.copyLatest(maxSamples, samples);
+                    if (subscriber.decimator.factor > 1) {
+                        std::vector<T>  envelope;
+                        MinMaxDecimator decimator{.factor = subscriber.decimator.factor};
+                        decimator.process(std::span(std::as_const(samples)), envelope);
+                        decimator.flush(envelope);
+                        samples = std::move(envelope);
+                    }
+                    setSamples(reply, std::span(std::as_const(samples)), subscriber.sample_format);
+                    setTimeBase(reply, pollerEntry.timeStampOf(firstSample), pollerEntry.sampleInterval(subscriber.decimator.factor));
+                }
+            },
+            pollerEntry.history.samples);
+        super_t::notify(subscriber.context, reply);
+    }
 
-        if (!pollerEntry.poller) {
-            return true;
+    void handleStreamingSubscription(const PollerKey& key, StreamingPollerEntry& pollerEntry) {
+        const bool finished = std::visit(
+            [this, &key, &pollerEntry]<typename TPoller>(const TPoller& poller) {
+                if constexpr (std::is_same_v<TPoller, std::monostate>) {
+                    return true;
+                } else {
+                    return handleStreamingSubscription(key, pollerEntry, *poller);
+                }
+            },
+            pollerEntry.poller);
+        if (pollerEntry.migrating && finished) {
+            pollerEntry.cutOver();
         }
-        Acquisition reply;
+    }
 
-        auto processData = [&reply, signalName, &pollerEntry](std::span<const double> data, std::span<const gr::Tag> tags) {
+    template<typename TPoller>
+    bool handleStreamingSubscription(const PollerKey& key, StreamingPollerEntry& pollerEntry, TPoller& poller) {
+        auto&      reply = pollerEntry.reply;
+        const auto now   = std::chrono::steady_clock::now();
+
+        auto processData = [this, &reply, &key, &pollerEntry, &now]<typename T>(std::span<const T> data, std::span<const gr::Tag> tags) {
             pollerEntry.populateFromTags(tags);
             reply.acqTriggerName = "STREAMING";
-            reply.channelName    = pollerEntry.signal_name.value_or(std::string(signalName));
+            reply.channelName    = pollerEntry.signal_name.value_or(key.signal_name);
             reply.channelUnit    = pollerEntry.signal_unit.value_or("N/A");
             // work around fix the Annotated::operator= ambiguity here (move vs. copy assignment) when creating a temporary unit here
             // Should be fixed in Annotated (templated forwarding assignment operator=?)/or go for gnuradio4's Annotated?
@@ -395,100 +1858,371 @@ private:
             const typename decltype(reply.channelRangeMax)::R rangeMax = pollerEntry.signal_max ? static_cast<float>(*pollerEntry.signal_max) : std::numeric_limits<float>::max();
             reply.channelRangeMin                                      = rangeMin;
             reply.channelRangeMax                                      = rangeMax;
-            reply.channelValue.resize(data.size());
-            reply.channelError.resize(data.size());
-            reply.channelTimeBase.resize(data.size());
-            std::transform(data.begin(), data.end(), reply.channelValue.begin(), detail::doubleToFloat);
-            std::copy(data.begin(), data.end(), reply.channelValue.begin());
-            std::fill(reply.channelError.begin(), reply.channelError.end(), 0.f);     // TODO
-            std::fill(reply.channelTimeBase.begin(), reply.channelTimeBase.end(), 0); // TODO
+            // no per-sample errors available for streaming data, sent as empty vector instead of a zero-filled one
+            reply.channelError.value().clear();
+            const auto firstSample = pollerEntry.samples_seen;
+            for (auto& [_, subscriber] : pollerEntry.subscribers) {
+                auto& pending = samplesOf<T>(subscriber.pending);
+                if (subscriber.decimator.factor > 1) {
+                    if (pending.empty()) {
+                        subscriber.pending_first_sample = firstSample - subscriber.decimator.bin_fill;
+                        subscriber.pending_since        = now;
+                    }
+                    subscriber.decimator.process(data, pending);
+                    subscriber.dropOldest(pending);
+                } else if (pending.empty() && subscriber.isDue(now)) {
+                    // nothing to merge, send directly from the poller's buffer
+                    setSamples(reply, data, subscriber.sample_format);
+                    setTimeBase(reply, pollerEntry.timeStampOf(firstSample), pollerEntry.sampleInterval(1));
+                    notifySubscriber(pollerEntry.statistics, subscriber, reply, now, now);
+                } else {
+                    if (pending.empty()) {
+                        subscriber.pending_first_sample = firstSample;
+                        subscriber.pending_since        = now;
+                    }
+                    pending.insert(pending.end(), data.begin(), data.end());
+                    subscriber.dropOldest(pending);
+                }
+            }
+            if (pollerEntry.retain_history) {
+                pollerEntry.history.append(data, firstSample, pollerEntry.sample_rate);
+            }
+            pollerEntry.samples_seen += data.size();
+            pollerEntry.statistics.samples += data.size();
         };
-        pollerEntry.in_use = true;
 
-        const auto wasFinished = pollerEntry.poller->finished.load();
-        if (pollerEntry.poller->process(processData)) {
-            super_t::notify(context, reply);
+        // samples the sink dropped for a non-blocking (DropOldest) poller are accounted to all of its subscribers
+        if (const auto sinkDropped = poller.drop_count.exchange(0); sinkDropped > 0) {
+            for (auto& [_, subscriber] : pollerEntry.subscribers) {
+                subscriber.dropped += sinkDropped;
+            }
+            pollerEntry.history.clear(); // a backfill must not span the gap
         }
-        return wasFinished;
+        // lossless subscribers hold back the (blocking) poller while their queue is full
+        std::size_t maxSamples = std::numeric_limits<std::size_t>::max();
+        if (key.overflow_policy == OverflowPolicy::Lossless) {
+            for (const auto& [_, subscriber] : pollerEntry.subscribers) {
+                maxSamples = std::min(maxSamples, subscriber.queueCapacity(now));
+            }
+        }
+
+        const auto wasFinished   = poller.finished.load();
+        const auto samplesBefore = pollerEntry.samples_seen;
+        if (maxSamples > 0) {
+            std::ignore = poller.process(processData, maxSamples);
+        }
+        const bool drained = maxSamples == std::numeric_limits<std::size_t>::max() || pollerEntry.samples_seen - samplesBefore < maxSamples;
+
+        for (auto& [_, subscriber] : pollerEntry.subscribers) {
+            std::visit(
+                [&]<typename TBuffer>(TBuffer& pending) {
+                    if constexpr (!std::is_same_v<TBuffer, std::monostate>) {
+                        // flush everything once the poller finished, the pending data would be lost otherwise
+                        if (wasFinished && drained) {
+                            subscriber.decimator.flush(pending);
+                        }
+                        if (!pending.empty() && (subscriber.isDue(now) || wasFinished)) {
+                            setSamples(reply, std::span(std::as_const(pending)), subscriber.sample_format);
+                            setTimeBase(reply, pollerEntry.timeStampOf(subscriber.pending_first_sample), pollerEntry.sampleInterval(subscriber.decimator.factor));
+                            notifySubscriber(pollerEntry.statistics, subscriber, reply, now, subscriber.pending_since);
+                            pending.clear();
+                        }
+                    }
+                },
+                subscriber.pending);
+        }
+        // a lossless poller that finished still needs another round if the queue limit kept it from being drained
+        return wasFinished && drained;
     }
 
-    auto getDataSetPoller(std::map<PollerKey, DataSetPollerEntry>& pollers, const TimeDomainContext& context, AcquisitionMode mode, std::string_view signalName) {
-        const auto key = PollerKey{.mode = mode, .signal_name = std::string(signalName), .pre_samples = static_cast<std::size_t>(context.preSamples), .post_samples = static_cast<std::size_t>(context.postSamples), .maximum_window_size = static_cast<std::size_t>(context.maximumWindowSize), .snapshot_delay = std::chrono::nanoseconds(context.snapshotDelay), .trigger_name = context.triggerNameFilter};
+    void notifySubscriber(PollerStatistics& statistics, StreamingSubscriber& subscriber, Acquisition& reply, std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point readFromSink) {
+        // Workaround for Annotated, see above
+        const typename decltype(reply.status)::R status = reply.status.value() | droppedSamplesStatus(subscriber.dropped);
+        reply.status                                    = status;
+        super_t::notify(subscriber.context, reply);
+        statistics.recordNotification(reply, std::chrono::steady_clock::now() - readFromSink);
+        subscriber.dropped     = 0;
+        subscriber.last_update = now;
+    }
 
-        auto pollerIt = pollers.find(key);
-        if (pollerIt == pollers.end()) {
-            auto matcher = [trigger_name = context.triggerNameFilter](std::string_view, const gr::Tag& tag, const gr::property_map&) {
-                using enum gr::trigger::MatchResult;
-                const auto v = tag.get(gr::tag::TRIGGER_NAME);
-                if (trigger_name.empty()) {
-                    return v ? Matching : Ignore;
+    static auto makeTriggerMatcher(std::string triggerName) {
+        return [trigger_name = std::move(triggerName)](std::string_view, const gr::Tag& tag, const gr::property_map&) {
+            using enum gr::trigger::MatchResult;
+            const auto v = tag.get(gr::tag::TRIGGER_NAME);
+            if (trigger_name.empty()) {
+                return v ? Matching : Ignore;
+            }
+            try {
+                if (!v) {
+                    return Ignore;
                 }
-                try {
-                    if (!v) {
-                        return Ignore;
+                return std::get<std::string>(v->get()) == trigger_name ? Matching : NotMatching;
+            } catch (...) {
+                return NotMatching;
+            }
+        };
+    }
+
+    void addDataSetSubscriber(std::map<PollerKey, DataSetPollerEntry>& pollers, std::string topic, const TimeDomainContext& context, AcquisitionMode mode, SampleFormat sampleFormat, std::string_view signalName) {
+        // the window sizes are not part of the key, see DataSetPollerEntry. Snapshots at multiple delays are read from a trigger
+        // window covering all of them, which is shared by all such subscriptions of the signal and trigger.
+        auto       snapshotDelays = mode == AcquisitionMode::Snapshot ? parseSnapshotDelays(context.snapshotDelays) : std::vector<std::chrono::nanoseconds>{};
+        const auto key            = PollerKey{.mode = mode, .signal_name = std::string(signalName), .snapshot_delay = std::chrono::nanoseconds(mode == AcquisitionMode::Snapshot && snapshotDelays.empty() ? context.snapshotDelay : 0), .trigger_name = context.triggerNameFilter, .snapshot_window = !snapshotDelays.empty()};
+        auto&      pollerEntry    = pollers[key];
+        auto&      subscriber     = pollerEntry.subscribers.emplace_back(DataSetSubscriber{.context = context, .topic = std::move(topic), .sample_format = sampleFormat, .decimation_factor = static_cast<std::size_t>(std::max(context.decimationFactor, 1)), .max_batch_size = static_cast<std::size_t>(std::max(context.maxBatchSize, 1)), .snapshot_delays = std::move(snapshotDelays)});
+        if (mode == AcquisitionMode::Triggered) {
+            subscriber.pre_samples  = static_cast<std::size_t>(context.preSamples);
+            subscriber.post_samples = static_cast<std::size_t>(context.postSamples);
+        } else if (mode == AcquisitionMode::Multiplexed) {
+            subscriber.maximum_window_size = static_cast<std::size_t>(context.maximumWindowSize);
+        }
+        pollerEntry.in_use = true;
+    }
+
+    /// Creates a poller on the sink of the flow graph whose window covers all subscribers of the entry and binds those no other poller serves to it
+    void createDataSetPoller(const PollerKey& key, DataSetPollerEntry& pollerEntry, const RunningFlowGraph* flowGraph) {
+        DataSetPoller poller{.id = pollerEntry.next_poller_id};
+        for (const auto& subscriber : pollerEntry.subscribers) {
+            poller.pre_samples         = std::max(poller.pre_samples, subscriber.pre_samples);
+            poller.post_samples        = std::max(poller.post_samples, subscriber.post_samples);
+            poller.maximum_window_size = std::max(poller.maximum_window_size, subscriber.maximum_window_size);
+        }
+        poller.poller = findDataSetPoller(key, poller, flowGraph);
+        if (poller.poller.index() == 0) {
+            return;
+        }
+        ++pollerEntry.next_poller_id;
+        for (auto& subscriber : pollerEntry.subscribers) {
+            if (!subscriber.poller) {
+                subscriber.poller                   = poller.id;
+                pollerEntry.bound[subscriber.topic] = poller.id;
+            }
+        }
+        pollerEntry.pollers.push_back(std::move(poller));
+        if (!pollerEntry.triggered) {
+            pollerEntry.triggered = registerWakeupCallback(key, *flowGraph); // one callback for all pollers of the entry
+        }
+    }
+
+    /// Dataset poller with the window of the given one on the sink of the key's signal, empty if the flow graph has no such sink
+    static AnyDataSetPoller findDataSetPoller(const PollerKey& key, const DataSetPoller& window, const RunningFlowGraph* flowGraph) {
+        return std::visit(
+            [&key, &window]<typename TSink>(TSink sink) -> AnyDataSetPoller {
+                if constexpr (std::is_same_v<TSink, std::monostate>) {
+                    return {};
+                } else {
+                    if (key.mode == AcquisitionMode::Triggered || key.snapshot_window) {
+                        return sink->getTriggerPoller(makeTriggerMatcher(key.trigger_name), window.pre_samples, window.post_samples);
+                    } else if (key.mode == AcquisitionMode::Snapshot) {
+                        return sink->getSnapshotPoller(makeTriggerMatcher(key.trigger_name), key.snapshot_delay);
+                    } else if (key.mode == AcquisitionMode::Multiplexed) {
+                        return sink->getMultiplexedPoller(makeTriggerMatcher(key.trigger_name), window.maximum_window_size);
                     }
-                    return std::get<std::string>(v->get()) == trigger_name ? Matching : NotMatching;
-                } catch (...) {
-                    return NotMatching;
+                    return {};
                 }
-            };
-            const auto query = basic::DataSinkQuery::signalName(signalName);
-            // TODO for triggered/multiplexed subscriptions that only differ in preSamples/postSamples/maximumWindowSize, we could use a single poller for the encompassing range
-            // and send snippets from their datasets to the individual subscribers
-            if (mode == AcquisitionMode::Triggered) {
-                pollerIt = pollers.emplace(key, basic::DataSinkRegistry::instance().getTriggerPoller<double>(query, std::move(matcher), key.pre_samples, key.post_samples)).first;
-            } else if (mode == AcquisitionMode::Snapshot) {
-                pollerIt = pollers.emplace(key, basic::DataSinkRegistry::instance().getSnapshotPoller<double>(query, std::move(matcher), key.snapshot_delay)).first;
-            } else if (mode == AcquisitionMode::Multiplexed) {
-                pollerIt = pollers.emplace(key, basic::DataSinkRegistry::instance().getMultiplexedPoller<double>(query, std::move(matcher), key.maximum_window_size)).first;
+            },
+            flowGraph ? flowGraph->sink(key.signal_name) : AnySink{});
+    }
+
+    /**
+     * Registers a sink callback that wakes up the notify thread when a dataset for the given key may have become available, so
+     * triggers reach the subscribers without waiting for the next polling cycle, and returns the flag the callback sets. The
+     * callback only copies the minimum needed to fire at the right sample (the sample after the trigger for triggered, the single
+     * sample for snapshot, and one sample after the window-closing trigger for multiplexed mode); the post-trigger samples of the
+     * window are waited for by the notify thread (see DataSetPollerEntry::window_complete). There is one callback per signal,
+     * trigger and mode of a flow graph, whatever the windows of the subscriptions (see WakeupCallbacks).
+     */
+    TriggerFlag registerWakeupCallback(const PollerKey& key, const RunningFlowGraph& flowGraph) {
+        return flowGraph.wakeup_callbacks.registerCallback(key, [&key, sink = flowGraph.sink(key.signal_name)]<typename TCallback>(const TCallback& wakeup) {
+            std::visit(
+                [&key, &wakeup]<typename TSink>(TSink s) {
+                    if constexpr (!std::is_same_v<TSink, std::monostate>) {
+                        if (key.mode == AcquisitionMode::Triggered || key.snapshot_window || key.mode == AcquisitionMode::Multiplexed) {
+                            s->registerTriggerCallback(makeTriggerMatcher(key.trigger_name), 0UZ, 1UZ, auto(wakeup));
+                        } else if (key.mode == AcquisitionMode::Snapshot) {
+                            s->registerSnapshotCallback(makeTriggerMatcher(key.trigger_name), key.snapshot_delay, auto(wakeup));
+                        }
+                    }
+                },
+                sink);
+        });
+    }
+
+    /// Fills the reply for the samples [offset, offset + count) of a dataset. Replies are reused, every field set for a dataset is
+    /// set (or reset) for all of them.
+    template<typename T>
+    static void fillAcquisition(Acquisition& reply, const gr::DataSet<T>& dataSet, std::string_view signalName, std::optional<float> sampleRate, std::size_t offset, std::size_t count, const DataSetSubscriber& subscriber) {
+        reply.acqTriggerName = dataSet.timing_events.empty() ? std::string() : detail::findTriggerName(dataSet.timing_events[0]);
+        reply.channelError.value().clear();
+
+        // time base: the first sample's timestamp is derived from the timing tag of the trigger (or the dataset's timestamp)
+        // Workaround for Annotated, see above
+        typename decltype(reply.acqTriggerTimeStamp)::R acqTriggerTimeStamp  = 0;
+        std::int64_t                                    firstSampleTimeStamp = dataSet.timestamp;
+        std::optional<double>                           sampleInterval;
+        if (sampleRate && *sampleRate > 0.f) {
+            sampleInterval = 1.0 / static_cast<double>(*sampleRate);
+            if (const auto trigger = detail::findTriggerTime(dataSet.timing_events.empty() ? std::span<const gr::Tag>{} : std::span<const gr::Tag>(dataSet.timing_events[0]))) {
+                const auto [triggerIndex, triggerTimeStamp] = *trigger;
+                acqTriggerTimeStamp                         = triggerTimeStamp;
+                firstSampleTimeStamp                        = triggerTimeStamp - std::llround(static_cast<double>(triggerIndex) * *sampleInterval * 1e9);
+            }
+            if (firstSampleTimeStamp != 0) {
+                firstSampleTimeStamp += std::llround(static_cast<double>(offset) * *sampleInterval * 1e9);
+            }
+            if (subscriber.decimation_factor > 1) {
+                *sampleInterval *= static_cast<double>(subscriber.decimation_factor) / 2.0; // the min/max envelope has two points per bin
             }
         }
-        return pollerIt;
+        reply.acqTriggerTimeStamp = acqTriggerTimeStamp;
+        setTimeBase(reply, firstSampleTimeStamp, sampleInterval);
+
+        reply.channelName = dataSet.signal_names.empty() ? std::string(signalName) : dataSet.signal_names[0];
+        reply.channelUnit = dataSet.signal_units.empty() ? "N/A" : dataSet.signal_units[0];
+        // Workaround for Annotated, see above
+        typename decltype(reply.channelRangeMin)::R rangeMin{};
+        typename decltype(reply.channelRangeMax)::R rangeMax{};
+        if (!dataSet.signal_ranges.empty() && dataSet.signal_ranges[0].size() == 2) {
+            rangeMin = static_cast<float>(dataSet.signal_ranges[0][0]);
+            rangeMax = static_cast<float>(dataSet.signal_ranges[0][1]);
+        }
+        reply.channelRangeMin = rangeMin;
+        reply.channelRangeMax = rangeMax;
+        const auto values = std::span(dataSet.signal_values).subspan(offset, count);
+        if (subscriber.decimation_factor > 1) {
+            MinMaxDecimator decimator{.factor = subscriber.decimation_factor};
+            std::vector<T>  envelope;
+            envelope.reserve(2 * (values.size() / subscriber.decimation_factor + 1));
+            decimator.process(values, envelope);
+            decimator.flush(envelope);
+            setSamples(reply, std::span(std::as_const(envelope)), subscriber.sample_format);
+            return; // errors do not apply to the envelope
+        }
+        setSamples(reply, std::span<const T>(values), subscriber.sample_format);
+        // errors are only sent if the sink provides them, the time base is not available yet (both are left empty otherwise)
+        if (dataSet.signal_errors.size() == dataSet.signal_values.size()) {
+            const auto errors = std::span(dataSet.signal_errors).subspan(offset, count);
+            reply.channelError.resize(errors.size());
+            detail::narrowToFloat(std::span<const T>(errors), std::span(reply.channelError.value()));
+        }
     }
 
-    bool handleDataSetSubscription(std::map<PollerKey, DataSetPollerEntry>& pollers, const TimeDomainContext& context, AcquisitionMode mode, std::string_view signalName) {
-        auto pollerIt = getDataSetPoller(pollers, context, mode, signalName);
-        if (pollerIt == pollers.end()) { // flushing, do not create new pollers
-            return true;
+    /**
+     * The reply for snapshots at multiple delays (TimeDomainContext::snapshotDelays): one value per delay, in the order of the
+     * requested delays, read from the trigger window of the poller. The first sample timestamp is that of the trigger, the sample
+     * interval is 0 as the values are not uniformly spaced. Delays beyond the end of the window (which is cut short at the end of
+     * the data) are left out.
+     */
+    template<typename T>
+    static void fillSnapshotAcquisition(Acquisition& reply, const gr::DataSet<T>& dataSet, std::string_view signalName, std::optional<float> sampleRate, std::size_t triggerIndex, const DataSetSubscriber& subscriber) {
+        fillAcquisition(reply, dataSet, signalName, sampleRate, std::min(triggerIndex, dataSet.signal_values.size()), 0UZ, subscriber);
+        const bool     hasErrors = dataSet.signal_errors.size() == dataSet.signal_values.size();
+        std::vector<T> values;
+        std::vector<T> errors;
+        values.reserve(subscriber.snapshot_offsets.size());
+        for (const auto offset : subscriber.snapshot_offsets) {
+            const auto index = static_cast<std::ptrdiff_t>(triggerIndex) + offset;
+            if (index < 0 || static_cast<std::size_t>(index) >= dataSet.signal_values.size()) {
+                continue;
+            }
+            values.push_back(dataSet.signal_values[static_cast<std::size_t>(index)]);
+            if (hasErrors) {
+                errors.push_back(dataSet.signal_errors[static_cast<std::size_t>(index)]);
+            }
         }
+        setSamples(reply, std::span(std::as_const(values)), subscriber.sample_format);
+        reply.channelError.resize(errors.size());
+        detail::narrowToFloat(std::span(std::as_const(errors)), std::span(reply.channelError.value()));
+        // Workaround for Annotated, see handleStreamingSubscription()
+        const typename decltype(reply.channelSampleInterval)::R nonUniform = 0.0f;
+        reply.channelSampleInterval                                       = nonUniform;
+    }
 
-        const auto& key         = pollerIt->first;
-        auto&       pollerEntry = pollerIt->second;
-
-        if (!pollerEntry.poller) {
-            return true;
+    void handleDataSetSubscription(const PollerKey& key, DataSetPollerEntry& pollerEntry, const RunningFlowGraph* flowGraph) {
+        std::size_t postSamples = 0;
+        bool        cutOver     = false;
+        for (auto& dataSetPoller : pollerEntry.pollers) {
+            const bool finished = std::visit(
+                [this, &key, &pollerEntry, &dataSetPoller]<typename TPoller>(const TPoller& poller) {
+                    if constexpr (std::is_same_v<TPoller, std::monostate>) {
+                        return true;
+                    } else {
+                        return handleDataSetSubscription(key, pollerEntry, dataSetPoller, *poller);
+                    }
+                },
+                dataSetPoller.poller);
+            if (dataSetPoller.migrating && finished) {
+                dataSetPoller.cutOver();
+                cutOver = true;
+            }
+            postSamples = std::max(postSamples, dataSetPoller.post_samples);
+        }
+        if (cutOver) {
+            pollerEntry.completeCutOver();
+        }
+        // the wakeup callback fires at the trigger, the window is complete once its post-trigger samples arrived
+        if (pollerEntry.takeTriggered() && postSamples > 1 && pollerEntry.sample_rate && *pollerEntry.sample_rate > 0.f) {
+            const auto postTrigger      = std::chrono::duration<double>(static_cast<double>(postSamples) / static_cast<double>(*pollerEntry.sample_rate));
+            pollerEntry.window_complete = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(postTrigger);
         }
-        Acquisition reply;
-        auto        processData = [&reply, &key, signalName, &pollerEntry](std::span<const gr::DataSet<double>> dataSets) {
-            const auto& dataSet = dataSets[0];
-            if (!dataSet.timing_events.empty()) {
-                reply.acqTriggerName = detail::findTriggerName(dataSet.timing_events[0]);
-            }
-            reply.channelName = dataSet.signal_names.empty() ? std::string(signalName) : dataSet.signal_names[0];
-            reply.channelUnit = dataSet.signal_units.empty() ? "N/A" : dataSet.signal_units[0];
-            if (!dataSet.signal_ranges.empty() && dataSet.signal_ranges[0].size() == 2) {
-                // Workaround for Annotated, see above
-                const typename decltype(reply.channelRangeMin)::R rangeMin = dataSet.signal_ranges[0][0];
-                const typename decltype(reply.channelRangeMax)::R rangeMax = dataSet.signal_ranges[0][1];
-                reply.channelRangeMin                                      = rangeMin;
-                reply.channelRangeMax                                      = rangeMax;
-            }
-            reply.channelValue.resize(dataSet.signal_values.size());
-            std::transform(dataSet.signal_values.begin(), dataSet.signal_values.end(), reply.channelValue.begin(), detail::doubleToFloat);
-            reply.channelError.resize(dataSet.signal_errors.size());
-            std::transform(dataSet.signal_errors.begin(), dataSet.signal_errors.end(), reply.channelError.begin(), detail::doubleToFloat);
-            reply.channelTimeBase.resize(dataSet.signal_values.size());
-            std::fill(reply.channelTimeBase.begin(), reply.channelTimeBase.end(), 0); // TODO
-        };
-        pollerEntry.in_use = true;
 
-        const auto wasFinished = pollerEntry.poller->finished.load();
-        while (pollerEntry.poller->process(processData, 1)) {
-            super_t::notify(context, reply);
+        // subscribers the existing pollers do not cover get a new one, the others stay with theirs so no pending dataset is lost
+        if (std::ranges::any_of(pollerEntry.subscribers, [](const auto& subscriber) { return !subscriber.poller; })) {
+            createDataSetPoller(key, pollerEntry, flowGraph);
         }
+    }
 
+    /// Returns true if the poller had already finished before it was drained, so it is done for good
+    template<typename TPoller>
+    bool handleDataSetSubscription(const PollerKey& key, DataSetPollerEntry& pollerEntry, const DataSetPoller& dataSetPoller, TPoller& poller) {
+        const auto readFromSink = std::chrono::steady_clock::now();
+        const auto wasFinished  = poller.finished.load();
+        auto       processData  = [this, &key, &pollerEntry, &dataSetPoller, readFromSink]<typename T>(std::span<const gr::DataSet<T>> dataSets) {
+            for (const auto& dataSet : dataSets) {
+                pollerEntry.statistics.samples += dataSet.signal_values.size();
+                for (auto& subscriber : pollerEntry.subscribers) {
+                    if (subscriber.poller != dataSetPoller.id) {
+                        continue; // served by another poller of the entry
+                    }
+                    const auto [offset, count] = dataSetPoller.windowFor(key.mode, subscriber, dataSet.signal_values.size());
+                    auto& reply                = subscriber.reply;
+                    if (key.snapshot_window) {
+                        fillSnapshotAcquisition(reply, dataSet, key.signal_name, pollerEntry.sample_rate, dataSetPoller.pre_samples, subscriber);
+                    } else {
+                        fillAcquisition(reply, dataSet, key.signal_name, pollerEntry.sample_rate, offset, count, subscriber);
+                    }
+                    if (subscriber.max_batch_size <= 1) {
+                        super_t::notify(subscriber.context, reply);
+                        pollerEntry.statistics.recordNotification(reply, std::chrono::steady_clock::now() - readFromSink);
+                        continue;
+                    }
+                    if (!appendToBatch(subscriber.batch, reply)) {
+                        sendBatch(pollerEntry.statistics, subscriber, readFromSink);
+                        std::ignore = appendToBatch(subscriber.batch, reply);
+                    }
+                    if (subscriber.batch.batchSegmentSize.value().size() >= subscriber.max_batch_size) {
+                        sendBatch(pollerEntry.statistics, subscriber, readFromSink);
+                    }
+                }
+            }
+        };
+        while (poller.process(processData)) {
+        }
+        // batches only collect the datasets of one cycle
+        for (auto& subscriber : pollerEntry.subscribers) {
+            sendBatch(pollerEntry.statistics, subscriber, readFromSink);
+        }
         return wasFinished;
     }
+
+    void sendBatch(PollerStatistics& statistics, DataSetSubscriber& subscriber, std::chrono::steady_clock::time_point readFromSink) {
+        if (subscriber.batch.batchSegmentSize.value().empty()) {
+            return;
+        }
+        super_t::notify(subscriber.context, subscriber.batch);
+        statistics.recordNotification(subscriber.batch, std::chrono::steady_clock::now() - readFromSink);
+        subscriber.batch = {};
+    }
 };
 
 template<typename TAcquisitionWorker, units::basic_fixed_string serviceName, typename... Meta>
@@ -529,6 +2263,8 @@ private:
             _acquisition_worker.setGraph(std::move(grGraph));
         } catch (const std::string& e) {
             throw std::invalid_argument(fmt::format("Could not parse flow graph: {}", e));
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(fmt::format("Could not parse flow graph: {}", e.what()));
         }
     }
 
@@ -540,13 +2276,22 @@ private:
     void handleSetRequest(const flowgraph::FilterContext& /*filterIn*/, flowgraph::FilterContext& /*filterOut*/, const flowgraph::Flowgraph& in, flowgraph::Flowgraph& out) {
         {
             std::lock_guard lockGuard(_flow_graph_lock);
-            try {
-                auto grGraph = std::make_unique<gr::Graph>(gr::loadGrc(*_plugin_loader, in.flowgraph));
-                _flow_graph  = in;
-                out          = in;
-                _acquisition_worker.setGraph(std::move(grGraph));
-            } catch (const std::string& e) {
-                throw std::invalid_argument(fmt::format("Could not parse flow graph: {}", e));
+            // parameter edits are applied to the running flow graph, only structural changes load and start a new one
+            if (auto changes = detail::parameterChanges(_flow_graph.flowgraph, in.flowgraph)) {
+                _acquisition_worker.setParameters(*changes, [pluginLoader = _plugin_loader, grc = in.flowgraph] { return std::make_unique<gr::Graph>(gr::loadGrc(*pluginLoader, grc)); });
+                _flow_graph = in;
+                out         = in;
+            } else {
+                try {
+                    auto grGraph = std::make_unique<gr::Graph>(gr::loadGrc(*_plugin_loader, in.flowgraph));
+                    _flow_graph  = in;
+                    out          = in;
+                    _acquisition_worker.setGraph(std::move(grGraph));
+                } catch (const std::string& e) {
+                    throw std::invalid_argument(fmt::format("Could not parse flow graph: {}", e));
+                } catch (const std::exception& e) {
+                    throw std::invalid_argument(fmt::format("Could not parse flow graph: {}", e.what()));
+                }
             }
         }
         notifyUpdate();
@@ -564,6 +2309,43 @@ private:
     }
 };
 
+/**
+ * Read-only property with the runtime statistics of an acquisition worker (AcquisitionTelemetry): throughput, latency and queue
+ * depth per poller, and the duration of the worker's polling cycles. Subscribers get every new report.
+ */
+template<typename TAcquisitionWorker, units::basic_fixed_string serviceName, typename... Meta>
+class GnuRadioTelemetryWorker : public Worker<serviceName, TelemetryContext, Empty, AcquisitionTelemetry, Meta...> {
+    TAcquisitionWorker& _acquisition_worker;
+
+public:
+    using super_t = Worker<serviceName, TelemetryContext, Empty, AcquisitionTelemetry, Meta...>;
+
+    explicit GnuRadioTelemetryWorker(opencmw::URI<opencmw::STRICT> brokerAddress, const opencmw::zmq::Context& context, TAcquisitionWorker& acquisitionWorker, Settings settings = {}) : super_t(std::move(brokerAddress), {}, context, std::move(settings)), _acquisition_worker(acquisitionWorker) { init(); }
+
+    template<typename BrokerType>
+    explicit GnuRadioTelemetryWorker(const BrokerType& broker, TAcquisitionWorker& acquisitionWorker) : super_t(broker, {}), _acquisition_worker(acquisitionWorker) {
+        init();
+    }
+
+    ~GnuRadioTelemetryWorker() { _acquisition_worker.setTelemetryCallback({}); }
+
+private:
+    void init() {
+        super_t::setCallback([this](const RequestContext& rawCtx, const TelemetryContext& /*filterIn*/, const Empty& /*in*/, TelemetryContext& /*filterOut*/, AcquisitionTelemetry& out) {
+            if (rawCtx.request.command != opencmw::mdp::Command::Get) {
+                throw std::invalid_argument("Telemetry is read-only");
+            }
+            out = _acquisition_worker.telemetry();
+        });
+        _acquisition_worker.setTelemetryCallback([this](const AcquisitionTelemetry& telemetry) {
+            for (auto subTopic : super_t::activeSubscriptions()) {
+                const auto filterIn = opencmw::query::deserialise<TelemetryContext>(subTopic.params());
+                super_t::notify(filterIn, telemetry);
+            }
+        });
+    }
+};
+
 } // namespace opendigitizer::acq
 
 #endif // OPENDIGITIZER_SERVICE_GNURADIOWORKER_H
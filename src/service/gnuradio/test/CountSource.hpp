@@ -1,7 +1,9 @@
 #ifndef COUNTSOURCE_HPP
 #define COUNTSOURCE_HPP
 
+#include <chrono>
 #include <deque>
+#include <optional>
 
 template<typename T>
 struct CountSource : public gr::Block<CountSource<T>> {
@@ -16,19 +18,25 @@ struct CountSource : public gr::Block<CountSource<T>> {
     float                    signal_max    = std::numeric_limits<float>::max();    ///< maximum value of the signal
     std::string              direction     = "up";                                 ///< direction of the count, "up" or "down"
     std::vector<std::string> timing_tags;
+    uint32_t                 pause_at  = 0; ///< Sample index at which the production pauses for pause_ms
+    uint32_t                 pause_ms  = 0; ///< Duration of the pause, 0 means no pause
     std::size_t              _produced = 0;
     std::deque<gr::Tag>      _pending_tags;
 
-    GR_MAKE_REFLECTABLE(CountSource, out, n_samples, initial_value, sample_rate, signal_name, signal_unit, signal_min, signal_max, direction, timing_tags);
+    std::optional<std::chrono::steady_clock::time_point> _resume;
+
+    GR_MAKE_REFLECTABLE(CountSource, out, n_samples, initial_value, sample_rate, signal_name, signal_unit, signal_min, signal_max, direction, timing_tags, pause_at, pause_ms);
 
     void settingsChanged(const gr::property_map& /*old_settings*/, const gr::property_map& /*new_settings*/) {
         _produced = 0;
         _pending_tags.clear();
+        _resume.reset();
 
+        // "index,trigger name" or "index,trigger name,trigger time (UTC ns)"
         for (const auto& tagStr : timing_tags) {
             auto       view = tagStr | std::ranges::views::split(',');
             const auto segs = std::vector(view.begin(), view.end());
-            if (segs.size() != 2) {
+            if (segs.size() != 2 && segs.size() != 3) {
                 fmt::println(std::cerr, "Invalid tag: '{}'", tagStr);
                 continue;
             }
@@ -38,7 +46,17 @@ struct CountSource : public gr::Block<CountSource<T>> {
                 fmt::println(std::cerr, "Invalid tag index '{}'", segs[0]);
                 continue;
             }
-            _pending_tags.emplace_back(index, gr::property_map{{std::string{gr::tag::TRIGGER_NAME.key()}, std::string{segs[1].begin(), segs[1].end()}}});
+            gr::property_map map{{std::string{gr::tag::TRIGGER_NAME.key()}, std::string{segs[1].begin(), segs[1].end()}}};
+            if (segs.size() == 3) {
+                const auto    timeStr = std::string_view(segs[2].begin(), segs[2].end());
+                std::uint64_t time    = 0;
+                if (const auto& [_, ec] = std::from_chars(timeStr.begin(), timeStr.end(), time); ec != std::errc{}) {
+                    fmt::println(std::cerr, "Invalid tag time '{}'", segs[2]);
+                    continue;
+                }
+                map[std::string{gr::tag::TRIGGER_TIME.shortKey()}] = time;
+            }
+            _pending_tags.emplace_back(index, std::move(map));
         }
     }
 
@@ -52,6 +70,21 @@ struct CountSource : public gr::Block<CountSource<T>> {
             }
             n = std::min(n, samplesLeft);
         }
+        if (pause_ms > 0) {
+            if (_produced < pause_at) {
+                n = std::min(n, static_cast<std::size_t>(pause_at) - _produced);
+            } else if (_produced == pause_at) {
+                // the other blocks keep running, e.g. to deliver the samples produced so far
+                const auto now = std::chrono::steady_clock::now();
+                if (!_resume) {
+                    _resume = now + std::chrono::milliseconds(pause_ms);
+                }
+                if (now < *_resume) {
+                    output.publish(0UZ);
+                    return gr::work::Status::OK;
+                }
+            }
+        }
         // chunk data so that there's one tag max, at index 0 in the chunk
         auto tagIt = _pending_tags.begin();
         if (tagIt != _pending_tags.end()) {
@@ -9,6 +9,8 @@
 #include <boost/ut.hpp>
 #include <fmt/format.h>
 
+#include <GnuRadioRecorderWorker.hpp>
+#include <GnuRadioSpectraWorker.hpp>
 #include <GnuRadioWorker.hpp>
 
 #include "CountSource.hpp"
@@ -78,6 +80,8 @@ void waitWhile(auto condition) {
 struct TestSetup {
     using AcqWorker            = GnuRadioAcquisitionWorker<"/GnuRadio/Acquisition", description<"Provides data acquisition updates">>;
     using FgWorker             = GnuRadioFlowGraphWorker<AcqWorker, "/GnuRadio/FlowGraph", description<"Provides access to flow graph">>;
+    using SpWorker             = GnuRadioSpectraWorker<AcqWorker, "/GnuRadio/Spectra", description<"Provides spectra of the streaming signals">>;
+    using RcWorker             = GnuRadioRecorderWorker<"/GnuRadio/Recording", description<"Provides recorded data">>;
     gr::BlockRegistry registry = [] {
         gr::BlockRegistry r;
         registerTestBlocks(r);
@@ -85,15 +89,20 @@ struct TestSetup {
     }();
     gr::PluginLoader      pluginLoader = gr::PluginLoader(registry, {});
     majordomo::Broker<>   broker       = majordomo::Broker<>("/PrimaryBroker");
-    AcqWorker             acqWorker    = AcqWorker(broker, &pluginLoader, 50ms);
+    AcqWorker             acqWorker;
     FgWorker              fgWorker     = FgWorker(broker, &pluginLoader, {}, acqWorker);
+    SpWorker              spWorker     = SpWorker(broker, acqWorker, 50ms);
+    std::filesystem::path recordingDir = std::filesystem::temp_directory_path() / fmt::format("qa_GnuRadioWorker_{}", ::getpid());
+    RcWorker              rcWorker     = RcWorker(broker, RecorderSettings{.directory = recordingDir, .signals = {"recorded"}, .samples_per_signal = 1UZ << 16, .index_records = 1UZ << 10, .tag_records = 64UZ, .max_reply_samples = 600UZ}, 50ms);
     std::jthread          brokerThread;
     std::jthread          acqWorkerThread;
     std::jthread          fgWorkerThread;
+    std::jthread          spWorkerThread;
+    std::jthread          rcWorkerThread;
     zmq::Context          ctx;
     client::ClientContext client = makeClient(ctx);
 
-    explicit TestSetup(std::function<void(std::vector<SignalEntry>)> dnsCallback = {}) {
+    explicit TestSetup(std::function<void(std::vector<SignalEntry>)> dnsCallback = {}, std::size_t pollerThreadCount = 1, std::chrono::milliseconds acquisitionRate = 50ms) : acqWorker(broker, &pluginLoader, acquisitionRate, pollerThreadCount) {
         const auto brokerPubAddress = broker.bind(URI<>("mds://127.0.0.1:12345"));
         expect((brokerPubAddress.has_value() == "bound successful"_b));
         const auto brokerRouterAddress = broker.bind(URI<>("mdp://127.0.0.1:12346"));
@@ -103,14 +112,17 @@ struct TestSetup {
         brokerThread    = std::jthread([this] { broker.run(); });
         acqWorkerThread = std::jthread([this] { acqWorker.run(); });
         fgWorkerThread  = std::jthread([this] { fgWorker.run(); });
+        spWorkerThread  = std::jthread([this] { spWorker.run(); });
+        rcWorkerThread  = std::jthread([this] { rcWorker.run(); });
         // let's give everyone some time to spin up and sort themselves
         std::this_thread::sleep_for(100ms);
     }
 
-    void subscribeClient(const URI<>& uri, std::function<void(const Acquisition&)>&& handlerFnc) {
+    template<typename TReply = Acquisition>
+    void subscribeClient(const URI<>& uri, std::type_identity_t<std::function<void(const TReply&)>>&& handlerFnc) {
         client.subscribe(uri, [handler = std::move(handlerFnc)](const mdp::Message& update) {
             fmt::println("Client 'received message from service '{}' for topic '{}'", update.serviceName, update.topic.str());
-            Acquisition acq;
+            TReply      acq;
             IoBuffer    buffer(update.data);
             try {
                 const auto result = deserialise<YaS, ProtocolCheck::ALWAYS>(buffer, acq);
@@ -125,6 +137,28 @@ struct TestSetup {
         });
     }
 
+    /// Get request to the recorder, waits for the reply
+    mdp::Message getRecordingReply(std::string_view query) {
+        std::atomic<bool> receivedReply = false;
+        mdp::Message      result;
+        client.get(URI(fmt::format("mdp://127.0.0.1:12346/GnuRadio/Recording?{}", query)), [&](const mdp::Message& reply) {
+            result        = reply;
+            receivedReply = true;
+        });
+        waitWhile([&receivedReply] { return !receivedReply.load(); });
+        return result;
+    }
+
+    Acquisition getRecording(std::string_view query) {
+        auto        reply = getRecordingReply(query);
+        Acquisition acq;
+        if (reply.error.empty()) {
+            IoBuffer buffer(reply.data);
+            std::ignore = deserialise<YaS, ProtocolCheck::ALWAYS>(buffer, acq);
+        }
+        return acq;
+    }
+
     void setGrc(std::string_view grc, auto callback) {
         opendigitizer::flowgraph::Flowgraph fg{std::string(grc), {}};
         IoBuffer                            buffer;
@@ -148,6 +182,9 @@ struct TestSetup {
         brokerThread.join();
         acqWorkerThread.join();
         fgWorkerThread.join();
+        spWorkerThread.join();
+        rcWorkerThread.join();
+        std::filesystem::remove_all(recordingDir);
     }
 };
 
@@ -162,6 +199,9 @@ blocks:
       signal_unit: up unit
       signal_min: 0
       signal_max: 99
+      sample_rate: 10
+      timing_tags:
+        - 0,start,1000000000
   - name: delay_up
     id: gr::testing::Delay
     parameters:
@@ -212,6 +252,10 @@ connections:
             expect(acq.channelUnit.value() == "up unit"sv);
             expect(acq.channelRangeMin == 0.f);
             expect(acq.channelRangeMax == 99.f);
+            expect(eq(acq.channelSampleInterval.value(), 0.1f));
+            if (!acq.channelValue.empty()) { // extrapolated from the trigger time of the tag at sample 0, the sample value is its index
+                expect(eq(acq.channelFirstSampleTimeStamp.value(), 1'000'000'000 + static_cast<std::int64_t>(acq.channelValue.value()[0]) * 100'000'000));
+            }
             receivedUpData.insert(receivedUpData.end(), acq.channelValue.begin(), acq.channelValue.end());
             receivedUpCount = receivedUpData.size();
         });
@@ -246,47 +290,42 @@ connections:
         }
     };
 
-    "Flow graph management"_test = [] {
-        constexpr std::string_view grc1 = R"(
+    "Streaming - parallel poller threads"_test = [] {
+        constexpr std::string_view grc = R"(
 blocks:
   - name: count_up
     id: CountSource
     parameters:
       n_samples: 100
-  - name: delay
-    id: gr::testing::Delay
-    parameters:
-      delay_ms: 600
-  - name: test_sink_up
-    id: gr::basic::DataSink
-    parameters:
-      signal_name: count_up
-connections:
-  - [count_up, 0, delay, 0]
-  - [delay, 0, test_sink_up, 0]
-)";
-        constexpr std::string_view grc2 = R"(
-blocks:
   - name: count_down
     id: CountSource
     parameters:
       n_samples: 100
       initial_value: 99
       direction: down
-  - name: delay
+  - name: delay_up
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: delay_down
     id: gr::testing::Delay
     parameters:
       delay_ms: 600
+  - name: test_sink_up
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count_up
   - name: test_sink_down
     id: gr::basic::DataSink
     parameters:
       signal_name: count_down
 connections:
-  - [count_down, 0, delay, 0]
-  - [delay, 0, test_sink_down, 0]
+  - [count_up, 0, delay_up, 0]
+  - [delay_up, 0, test_sink_up, 0]
+  - [count_down, 0, delay_down, 0]
+  - [delay_down, 0, test_sink_down, 0]
 )";
-
-        TestSetup test;
+        TestSetup                test({}, 4UZ);
 
         constexpr std::size_t    kExpectedSamples = 100;
         const std::vector<float> expectedUpData   = getIota(kExpectedSamples);
@@ -295,123 +334,219 @@ connections:
 
         std::vector<float>       receivedUpData;
         std::atomic<std::size_t> receivedUpCount = 0;
+        std::vector<float>       receivedDownData;
+        std::atomic<std::size_t> receivedDownCount = 0;
 
         test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_up"), [&receivedUpData, &receivedUpCount](const auto& acq) {
             receivedUpData.insert(receivedUpData.end(), acq.channelValue.begin(), acq.channelValue.end());
             receivedUpCount = receivedUpData.size();
         });
-
-        std::vector<float>       receivedDownData;
-        std::atomic<std::size_t> receivedDownCount = 0;
-
         test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_down"), [&receivedDownData, &receivedDownCount](const auto& acq) {
             receivedDownData.insert(receivedDownData.end(), acq.channelValue.begin(), acq.channelValue.end());
             receivedDownCount = receivedDownData.size();
         });
 
         std::this_thread::sleep_for(50ms);
-        test.setGrc(grc1);
-        std::this_thread::sleep_for(1200ms);
-        test.setGrc(grc2);
+        test.setGrc(grc);
 
         waitWhile([&] { return receivedUpCount < kExpectedSamples || receivedDownCount < kExpectedSamples; });
 
-        expect(eq(receivedUpData.size(), kExpectedSamples));
         expect(eq(receivedUpData, expectedUpData));
-        expect(eq(receivedDownData.size(), kExpectedSamples));
         expect(eq(receivedDownData, expectedDownData));
     };
 
-    "Flow graph management non-terminating graphs"_test = [] {
-        constexpr std::string_view grc1 = R"(
+    "Streaming - float sink"_test = [] {
+        // load_grc only instantiates double blocks, so the float graph is created directly
+        auto  graph  = std::make_unique<gr::Graph>();
+        auto& source = graph->emplaceBlock<CountSource<float>>({{"n_samples", static_cast<std::uint32_t>(100)}, {"signal_name", "count_float"s}, {"signal_min", 0.f}, {"signal_max", 99.f}});
+        auto& sink   = graph->emplaceBlock<gr::basic::DataSink<float>>({{"signal_name", "count_float"s}});
+        expect(eq(graph->connect<"out">(source).to<"in">(sink), gr::ConnectionResult::SUCCESS));
+
+        TestSetup test;
+
+        constexpr std::size_t     kExpectedSamples = 100;
+        std::vector<float>        receivedData;
+        std::atomic<std::size_t>  receivedCount = 0;
+        std::vector<std::int16_t> receivedCodes;
+        std::atomic<std::size_t>  receivedCodeCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_float"), [&receivedData, &receivedCount](const auto& acq) {
+            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedCount = receivedData.size();
+        });
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_float&sampleFormat=int16"), [&receivedCodes, &receivedCodeCount](const auto& acq) {
+            expect(eq(acq.channelValue.size(), 0UZ));
+            receivedCodes.insert(receivedCodes.end(), acq.channelRawValueInt16.value().begin(), acq.channelRawValueInt16.value().end());
+            receivedCodeCount = receivedCodes.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.acqWorker.setGraph(std::move(graph));
+
+        waitWhile([&] { return receivedCount < kExpectedSamples || receivedCodeCount < kExpectedSamples; });
+
+        expect(eq(receivedData, getIota(kExpectedSamples)));
+        expect(eq(receivedCodes.size(), kExpectedSamples));
+    };
+
+    "Streaming - raw int16 samples"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count_up
+    id: CountSource
+    parameters:
+      n_samples: 100
+      signal_unit: up unit
+      signal_min: 0
+      signal_max: 99
+  - name: delay_up
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink_up
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count_up
+connections:
+  - [count_up, 0, delay_up, 0]
+  - [delay_up, 0, test_sink_up, 0]
+)";
+        TestSetup                  test;
+
+        constexpr std::size_t    kExpectedSamples = 100;
+        std::vector<float>       receivedData;
+        std::atomic<std::size_t> receivedCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_up&sampleFormat=int16"), [&receivedData, &receivedCount](const auto& acq) {
+            expect(eq(acq.channelValue.size(), 0UZ));
+            expect(eq(acq.channelRawValueInt32.size(), 0UZ));
+            expect(eq(acq.channelRawOffset, 49.5));
+            expect(eq(acq.status.value() & (kStatusSamplesQuantised | kStatusSamplesClipped), kStatusSamplesQuantised));
+            for (const auto code : acq.channelRawValueInt16.value()) {
+                receivedData.push_back(static_cast<float>(acq.channelRawOffset.value() + acq.channelRawScale.value() * static_cast<double>(code)));
+            }
+            receivedCount = receivedData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedCount < kExpectedSamples; });
+
+        expect(eq(receivedData.size(), kExpectedSamples));
+        const auto expectedData = getIota(kExpectedSamples);
+        for (std::size_t i = 0; i < std::min(receivedData.size(), expectedData.size()); ++i) {
+            expect(std::abs(receivedData[i] - expectedData[i]) < 0.01f) << "sample" << i;
+        }
+    };
+
+    "Streaming - update frequency"_test = [] {
+        constexpr std::string_view grc = R"(
 blocks:
   - name: source
     id: ForeverSource
   - name: test_sink
     id: gr::basic::DataSink
     parameters:
-      signal_name: test1
+      signal_name: test
 connections:
   - [source, 0, test_sink, 0]
 )";
-        constexpr std::string_view grc2 = R"(
+        TestSetup                  test;
+
+        std::atomic<std::size_t> receivedUpdates = 0;
+        std::atomic<std::size_t> receivedCount   = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test&maxClientUpdateFrequencyFilter=2"), [&receivedUpdates, &receivedCount](const auto& acq) {
+            ++receivedUpdates;
+            receivedCount += acq.channelValue.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedUpdates < 3; });
+        const auto start = std::chrono::steady_clock::now();
+        waitWhile([&] { return receivedUpdates < 5; });
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        // at 2 Hz, two more updates take at least ~1s, while the worker polls every 50ms; data is merged, not dropped
+        expect(elapsed > 800ms);
+        expect(receivedCount > 0UZ);
+    };
+
+    "Streaming - overflow policies"_test = [] {
+        constexpr std::string_view grc = R"(
 blocks:
   - name: source
     id: ForeverSource
   - name: test_sink
     id: gr::basic::DataSink
     parameters:
-      signal_name: test2
+      signal_name: test
 connections:
   - [source, 0, test_sink, 0]
 )";
+        TestSetup test;
 
-        std::mutex               dnsMutex;
-        std::vector<SignalEntry> lastDnsEntries;
-        TestSetup                test([&lastDnsEntries, &dnsMutex](auto entries) {
-            if (!entries.empty()) {
-                std::lock_guard lock(dnsMutex);
-                lastDnsEntries = std::move(entries);
+        std::atomic<std::size_t>  droppingUpdates = 0;
+        std::atomic<std::int64_t> droppedCount    = 0;
+        std::atomic<std::size_t>  maxDroppingSize = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test&maxClientUpdateFrequencyFilter=2&overflowPolicy=drop-oldest&maxQueuedSamples=10"), [&](const auto& acq) {
+            if (++droppingUpdates > 1) { // the first update is sent directly from the poller, without queueing
+                maxDroppingSize = std::max(maxDroppingSize.load(), acq.channelValue.size());
+            }
+            if (acq.status.value() & kStatusSamplesDropped) {
+                droppedCount += acq.status.value() >> kStatusDroppedCountShift;
             }
         });
 
-        std::atomic<std::size_t> receivedCount1 = 0;
-        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test1"), [&receivedCount1](const auto& acq) { receivedCount1 += acq.channelValue.size(); });
-
-        std::atomic<std::size_t> receivedCount2 = 0;
-        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test2"), [&receivedCount2](const auto& acq) { receivedCount2 += acq.channelValue.size(); });
+        std::atomic<std::size_t> losslessUpdates = 0;
+        std::atomic<std::size_t> maxLosslessSize = 0;
+        std::atomic<bool>        losslessDropped = false;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test&maxClientUpdateFrequencyFilter=5&overflowPolicy=lossless&maxQueuedSamples=10"), [&](const auto& acq) {
+            if (++losslessUpdates > 1) {
+                maxLosslessSize = std::max(maxLosslessSize.load(), acq.channelValue.size());
+            }
+            if (acq.status.value() != 0) {
+                losslessDropped = true;
+            }
+        });
 
         std::this_thread::sleep_for(50ms);
-        test.setGrc(grc1);
-        std::this_thread::sleep_for(1200ms);
-
-        {
-            std::lock_guard lock(dnsMutex);
-            expect(eq(lastDnsEntries.size(), 1UZ));
-            expect(eq(lastDnsEntries[0].name, "test1"sv));
-        }
-        test.setGrc(grc2);
+        test.setGrc(grc);
 
-        constexpr auto kExpectedSamples = 50000UZ;
-        waitWhile([&] { return receivedCount1 < kExpectedSamples || receivedCount2 < kExpectedSamples; });
+        waitWhile([&] { return droppingUpdates < 3 || losslessUpdates < 3; });
 
-        std::lock_guard lock(dnsMutex);
-        expect(eq(lastDnsEntries.size(), 1UZ));
-        if (!lastDnsEntries.empty()) {
-            expect(eq(lastDnsEntries[0].name, "test2"sv));
-        }
+        expect(maxDroppingSize.load() <= 10UZ);
+        expect(droppedCount.load() > 0);
+        expect(maxLosslessSize.load() <= 10UZ);
+        expect(!losslessDropped.load());
     };
 
-    "Trigger - tightly packed tags"_test = [] {
+    "Streaming - min/max decimation"_test = [] {
         constexpr std::string_view grc = R"(
 blocks:
-  - name: count
+  - name: count_up
     id: CountSource
     parameters:
       n_samples: 100
-      timing_tags:
-        - 40,notatrigger
-        - 50,hello
-        - 60,ignoreme
-  - name: delay
+  - name: delay_up
     id: gr::testing::Delay
     parameters:
       delay_ms: 600
-  - name: test_sink
+  - name: test_sink_up
     id: gr::basic::DataSink
     parameters:
-      signal_name: count
+      signal_name: count_up
 connections:
-  - [count, 0, delay, 0]
-  - [delay, 0, test_sink, 0]
+  - [count_up, 0, delay_up, 0]
+  - [delay_up, 0, test_sink_up, 0]
 )";
         TestSetup                  test;
 
         std::vector<float>       receivedData;
         std::atomic<std::size_t> receivedCount = 0;
-
-        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=15"), [&receivedData, &receivedCount](const auto& acq) {
-            expect(acq.acqTriggerName.value() == "hello");
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_up&decimationFactor=10"), [&receivedData, &receivedCount](const auto& acq) {
             receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
             receivedCount = receivedData.size();
         });
@@ -421,65 +556,73 @@ connections:
 
         waitWhile([&] { return receivedCount < 20; });
 
-        expect(eq(receivedData, getIota(20, 45)));
+        std::vector<float> expectedData;
+        for (std::size_t bin = 0; bin < 10; ++bin) {
+            expectedData.push_back(static_cast<float>(bin * 10));
+            expectedData.push_back(static_cast<float>(bin * 10 + 9));
+        }
+        expect(eq(receivedData, expectedData));
     };
 
-    "Trigger - sparse tags"_test = [] {
-        // Tests that tags detection and offsets work when the tag data is spread among multiple threads
+    "Streaming - history backfill"_test = [] {
+        // the forever source keeps the flow graph running after the count source finished
         constexpr std::string_view grc = R"(
 blocks:
   - name: count
     id: CountSource
     parameters:
-      n_samples: 10000000
-      timing_tags:
-        - 1000,notatrigger
-        - 800000,hello
-        - 900000,ignoreme
-  - name: delay
-    id: gr::testing::Delay
-    parameters:
-      delay_ms: 600
-  - name: test_sink
+      n_samples: 1000
+  - name: count_sink
     id: gr::basic::DataSink
     parameters:
       signal_name: count
+      sample_rate: 1000
+  - name: forever
+    id: ForeverSource
+  - name: forever_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: forever
 connections:
-  - [count, 0, delay, 0]
-  - [delay, 0, test_sink, 0]
+  - [count, 0, count_sink, 0]
+  - [forever, 0, forever_sink, 0]
 )";
-        TestSetup                  test;
-
-        std::vector<float>       receivedData;
-        std::atomic<std::size_t> receivedCount = 0;
+        TestSetup test;
+        test.acqWorker.setHistoryRetention(60s, 1UZ << 20);
 
-        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=15"), [&receivedData, &receivedCount](const auto& acq) {
-            expect(acq.acqTriggerName.value() == "hello");
-            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
-            receivedCount = receivedData.size();
-        });
+        std::atomic<std::size_t> liveCount = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count"), [&liveCount](const auto& acq) { liveCount += acq.channelValue.size(); });
 
         std::this_thread::sleep_for(50ms);
         test.setGrc(grc);
+        waitWhile([&] { return liveCount < 1000UZ; });
+
+        // a late subscriber gets everything retained so far as its first update
+        std::mutex                      updatesMutex;
+        std::vector<std::vector<float>> updates;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&backfillDuration=10000000000"), [&](const auto& acq) {
+            std::lock_guard lock(updatesMutex);
+            updates.emplace_back(acq.channelValue.begin(), acq.channelValue.end());
+        });
+        waitWhile([&] {
+            std::lock_guard lock(updatesMutex);
+            return updates.empty();
+        });
 
-        waitWhile([&] { return receivedCount < 20; });
-
-        expect(eq(receivedData, getIota(20, 799995)));
+        std::lock_guard lock(updatesMutex);
+        expect(eq(updates.front(), getIota(1000)));
     };
 
-    "Multiplexed"_test = [] {
+    "Recording"_test = [] {
+        // the delay gives the recorder time to find the sink before the data arrives
         constexpr std::string_view grc = R"(
 blocks:
   - name: count
     id: CountSource
     parameters:
-      n_samples: 100
-      signal_unit: A unit
-      sample_rate: 10
+      n_samples: 1000
       timing_tags:
-        - 30,hello
-        - 50,start
-        - 70,hello
+        - 500,TRIG
   - name: delay
     id: gr::testing::Delay
     parameters:
@@ -487,42 +630,881 @@ blocks:
   - name: test_sink
     id: gr::basic::DataSink
     parameters:
-      signal_name: count
+      signal_name: recorded
 connections:
   - [count, 0, delay, 0]
   - [delay, 0, test_sink, 0]
 )";
-        std::vector<SignalEntry>   lastDnsEntries;
-        TestSetup                  test([&lastDnsEntries](auto entries) {
-            if (!entries.empty()) {
-                lastDnsEntries = std::move(entries);
-            }
-        });
+        TestSetup test;
+        test.setGrc(grc);
 
-        std::vector<float>       receivedData;
-        std::atomic<std::size_t> receivedCount = 0;
+        waitWhile([&] { return test.getRecording("channelNameFilter=recorded&triggerNameFilter=TRIG&postSamples=500").channelValue.size() < 500UZ; });
 
-        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=multiplexed&triggerNameFilter=start"), [&receivedData, &receivedCount](const auto& acq) {
-            expect(acq.acqTriggerName.value() == "start");
-            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
-            receivedCount = receivedData.size();
-        });
+        // replies are truncated to max_reply_samples
+        const auto all = test.getRecording("channelNameFilter=recorded");
+        expect(eq(all.channelName.value(), "recorded"s));
+        expect(eq(all.channelValue.value(), getIota(600)));
+        expect(eq(all.status.value(), kStatusReplyTruncated));
 
-        std::this_thread::sleep_for(50ms);
-        test.setGrc(grc);
+        const auto window = test.getRecording("channelNameFilter=recorded&triggerNameFilter=TRIG&preSamples=10&postSamples=10");
+        expect(eq(window.acqTriggerName.value(), "TRIG"s));
+        expect(eq(window.channelValue.value(), getIota(20, 490.f)));
+        expect(eq(window.status.value(), std::int64_t{0}));
 
-        waitWhile([&] { return receivedCount < 20; });
+        // an error reply for signals that are not recorded
+        const auto unknown = test.getRecordingReply("channelNameFilter=unknown");
+        expect(unknown.error.find("Signal 'unknown' is not recorded") != std::string::npos);
+        expect(unknown.data.empty());
 
-        expect(eq(receivedData, getIota(20, 50)));
-        expect(eq(lastDnsEntries.size(), 1UZ));
-        if (!lastDnsEntries.empty()) {
-            expect(eq(lastDnsEntries[0].name, "count"sv));
-            expect(eq(lastDnsEntries[0].unit, "A unit"sv));
-            expect(eq(lastDnsEntries[0].sample_rate, 10.f));
+        // sanitised signal names must not share a file
+        expect(throws([&test] { TestSetup::RcWorker(test.broker, RecorderSettings{.directory = test.recordingDir, .signals = {"a/b", "a_b"}}, 50ms); }));
+    };
+
+    "Recording - concurrent reads"_test = [] {
+        // small rings the writer wraps many times while the reader copies from them. Sample i has the value i and the timestamp i ms,
+        // so whatever the reader got is checkable
+        const auto path = std::filesystem::temp_directory_path() / fmt::format("qa_GnuRadioWorker_concurrent_{}.rec", ::getpid());
+        {
+            SignalRecording   recording(path, 1000, 16, 8);
+            std::atomic<bool> done = false;
+            std::jthread      writer([&] {
+                std::vector<float> chunk(997); // almost the whole ring
+                for (std::uint64_t first = 0; first < 16'000'000; first += chunk.size()) {
+                    std::iota(chunk.begin(), chunk.end(), static_cast<float>(first));
+                    const std::array tags{gr::Tag{0, gr::property_map{{std::string{gr::tag::SAMPLE_RATE.shortKey()}, 1000.f}, {std::string{gr::tag::TRIGGER_NAME.shortKey()}, "TRIG"s}, {std::string{gr::tag::TRIGGER_TIME.shortKey()}, first * 1'000'000}}}};
+                    recording.write(std::span(std::as_const(chunk)), std::span(tags));
+                }
+                done = true;
+            });
+
+            std::vector<float> samples;
+            do {
+                const auto [available, written] = recording.availableSamples();
+                const auto first                = recording.read(available, written, samples);
+                expect(ge(first, available));
+                expect(le(samples.size(), 1000UZ));
+                for (std::size_t i = 0; i < samples.size(); ++i) {
+                    if (samples[i] != static_cast<float>(first + i)) {
+                        expect(false) << "torn sample" << first + i;
+                        break;
+                    }
+                }
+                if (const auto trigger = recording.findTrigger("TRIG", 0)) {
+                    expect(eq(trigger->triggerName(), "TRIG"sv));
+                    expect(eq(trigger->sample % 997, 0UZ));
+                    expect(eq(trigger->timestamp, static_cast<std::int64_t>(trigger->sample * 1'000'000)));
+                }
+                // nothing is found if the writer lapped the index in the meantime, sampleAt() then answers the oldest sample left
+                if (const auto timeStamp = written > 0 ? recording.timeStampOf(written - 1) : std::nullopt) {
+                    expect(eq(*timeStamp, static_cast<std::int64_t>((written - 1) * 1'000'000)));
+                    expect(ge(recording.sampleAt(*timeStamp), written - 1));
+                }
+            } while (!done);
         }
+        std::filesystem::remove(path);
     };
 
-    "Snapshot"_test = [] {
+    "Flow graph management"_test = [] {
+        constexpr std::string_view grc1 = R"(
+blocks:
+  - name: count_up
+    id: CountSource
+    parameters:
+      n_samples: 100
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink_up
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count_up
+connections:
+  - [count_up, 0, delay, 0]
+  - [delay, 0, test_sink_up, 0]
+)";
+        constexpr std::string_view grc2 = R"(
+blocks:
+  - name: count_down
+    id: CountSource
+    parameters:
+      n_samples: 100
+      initial_value: 99
+      direction: down
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink_down
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count_down
+connections:
+  - [count_down, 0, delay, 0]
+  - [delay, 0, test_sink_down, 0]
+)";
+
+        TestSetup test;
+
+        constexpr std::size_t    kExpectedSamples = 100;
+        const std::vector<float> expectedUpData   = getIota(kExpectedSamples);
+        auto                     expectedDownData = expectedUpData;
+        std::reverse(expectedDownData.begin(), expectedDownData.end());
+
+        std::vector<float>       receivedUpData;
+        std::atomic<std::size_t> receivedUpCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_up"), [&receivedUpData, &receivedUpCount](const auto& acq) {
+            receivedUpData.insert(receivedUpData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedUpCount = receivedUpData.size();
+        });
+
+        std::vector<float>       receivedDownData;
+        std::atomic<std::size_t> receivedDownCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count_down"), [&receivedDownData, &receivedDownCount](const auto& acq) {
+            receivedDownData.insert(receivedDownData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedDownCount = receivedDownData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc1);
+        std::this_thread::sleep_for(1200ms);
+        test.setGrc(grc2);
+
+        waitWhile([&] { return receivedUpCount < kExpectedSamples || receivedDownCount < kExpectedSamples; });
+
+        expect(eq(receivedUpData.size(), kExpectedSamples));
+        expect(eq(receivedUpData, expectedUpData));
+        expect(eq(receivedDownData.size(), kExpectedSamples));
+        expect(eq(receivedDownData, expectedDownData));
+    };
+
+    "Flow graph management non-terminating graphs"_test = [] {
+        constexpr std::string_view grc1 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test1
+connections:
+  - [source, 0, test_sink, 0]
+)";
+        constexpr std::string_view grc2 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test2
+connections:
+  - [source, 0, test_sink, 0]
+)";
+
+        std::mutex               dnsMutex;
+        std::vector<SignalEntry> lastDnsEntries;
+        TestSetup                test([&lastDnsEntries, &dnsMutex](auto entries) {
+            if (!entries.empty()) {
+                std::lock_guard lock(dnsMutex);
+                lastDnsEntries = std::move(entries);
+            }
+        });
+
+        std::atomic<std::size_t> receivedCount1 = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test1"), [&receivedCount1](const auto& acq) { receivedCount1 += acq.channelValue.size(); });
+
+        std::atomic<std::size_t> receivedCount2 = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test2"), [&receivedCount2](const auto& acq) { receivedCount2 += acq.channelValue.size(); });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc1);
+        std::this_thread::sleep_for(1200ms);
+
+        {
+            std::lock_guard lock(dnsMutex);
+            expect(eq(lastDnsEntries.size(), 1UZ));
+            expect(eq(lastDnsEntries[0].name, "test1"sv));
+        }
+        test.setGrc(grc2);
+
+        constexpr auto kExpectedSamples = 50000UZ;
+        waitWhile([&] { return receivedCount1 < kExpectedSamples || receivedCount2 < kExpectedSamples; });
+
+        std::lock_guard lock(dnsMutex);
+        expect(eq(lastDnsEntries.size(), 1UZ));
+        if (!lastDnsEntries.empty()) {
+            expect(eq(lastDnsEntries[0].name, "test2"sv));
+        }
+    };
+
+    "Flow graph management seamless replacement"_test = [] {
+        constexpr std::string_view grc1 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test
+      signal_unit: V
+connections:
+  - [source, 0, test_sink, 0]
+)";
+        constexpr std::string_view grc2 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test
+      signal_unit: mV
+connections:
+  - [source, 0, test_sink, 0]
+)";
+
+        std::mutex               dnsMutex;
+        std::vector<SignalEntry> lastDnsEntries;
+        std::size_t              emptyDnsUpdates = 0;
+        TestSetup                test([&](auto entries) {
+            std::lock_guard lock(dnsMutex);
+            if (entries.empty()) {
+                ++emptyDnsUpdates;
+            } else {
+                lastDnsEntries = std::move(entries);
+            }
+        });
+
+        std::atomic<std::size_t> receivedCount = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test"), [&receivedCount](const auto& acq) { receivedCount += acq.channelValue.size(); });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc1);
+        waitWhile([&] { return receivedCount < 10000UZ; });
+
+        test.setGrc(grc2);
+        waitWhile([&] {
+            std::lock_guard lock(dnsMutex);
+            return lastDnsEntries.empty() || lastDnsEntries[0].unit != "mV";
+        });
+        // the subscription is kept across the replacement and served from the sinks of the new flow graph
+        const std::size_t countAfterSwap = receivedCount;
+        waitWhile([&] { return receivedCount < countAfterSwap + 10000UZ; });
+
+        std::lock_guard lock(dnsMutex);
+        expect(eq(emptyDnsUpdates, 0UZ)); // the signal was not unregistered in between
+        expect(eq(lastDnsEntries.size(), 1UZ));
+    };
+
+    "Flow graph management seamless replacement - triggered"_test = [] {
+        // neither flow graph finishes by itself, the second one pauses before its trigger so it fires while the first one retires
+        constexpr std::string_view grc1 = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      timing_tags:
+        - 50,hello
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, test_sink, 0]
+)";
+        constexpr std::string_view grc2 = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      initial_value: 1000
+      pause_at: 20
+      pause_ms: 100
+      timing_tags:
+        - 50,hello
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, test_sink, 0]
+)";
+        TestSetup test;
+
+        std::mutex         receivedMutex;
+        std::vector<float> receivedFirstValues;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=5"), [&](const auto& acq) {
+            expect(eq(acq.channelValue.value().size(), 10UZ));
+            std::lock_guard lock(receivedMutex);
+            receivedFirstValues.push_back(acq.channelValue.value().front());
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc1);
+        waitWhile([&] {
+            std::lock_guard lock(receivedMutex);
+            return receivedFirstValues.empty();
+        });
+
+        // the subscription migrates to the sink of the new flow graph, without recreating its poller after the old one stopped
+        test.setGrc(grc2);
+        waitWhile([&] {
+            std::lock_guard lock(receivedMutex);
+            return receivedFirstValues.size() < 2;
+        });
+        std::this_thread::sleep_for(200ms);
+
+        std::lock_guard lock(receivedMutex);
+        expect(eq(receivedFirstValues, std::vector{45.f, 1045.f}));
+    };
+
+    "Flow graph management parameter changes"_test = [] {
+        constexpr std::string_view grc1 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test
+      signal_unit: V
+      sample_rate: 1000
+connections:
+  - [source, 0, test_sink, 0]
+)";
+        constexpr std::string_view grc2 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test
+      signal_unit: mV
+      sample_rate: 2000
+connections:
+  - [source, 0, test_sink, 0]
+)";
+        constexpr std::string_view grc3 = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test
+connections:
+  - [source, 0, test_sink, 0]
+)";
+
+        const auto changes = opendigitizer::acq::detail::parameterChanges(grc1, grc2);
+        expect(changes.has_value());
+        if (changes) {
+            expect(eq(changes->size(), 1UZ));
+            expect(eq(changes->at("test_sink").at("signal_unit"), "mV"s));
+            expect(eq(changes->at("test_sink").at("sample_rate"), "2000"s));
+        }
+        expect(!opendigitizer::acq::detail::parameterChanges(grc1, grc3).has_value()); // removed parameters need a new flow graph
+        expect(!opendigitizer::acq::detail::parameterChanges(grc1, "blocks: [").has_value());
+
+        std::mutex               dnsMutex;
+        std::vector<SignalEntry> lastDnsEntries;
+        TestSetup                test([&](auto entries) {
+            std::lock_guard lock(dnsMutex);
+            lastDnsEntries = std::move(entries);
+        });
+
+        std::atomic<std::size_t> receivedCount = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test"), [&receivedCount](const auto& acq) { receivedCount += acq.channelValue.size(); });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc1);
+        waitWhile([&] { return receivedCount < 10000UZ; });
+
+        // sent to the running sink as settings, which reports them back
+        test.setGrc(grc2);
+        waitWhile([&] {
+            std::lock_guard lock(dnsMutex);
+            return lastDnsEntries.size() != 1 || lastDnsEntries[0].unit != "mV" || lastDnsEntries[0].sample_rate != 2000.f;
+        });
+        const std::size_t countAfterChange = receivedCount;
+        waitWhile([&] { return receivedCount < countAfterChange + 10000UZ; });
+    };
+
+    "Telemetry"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: source
+    id: ForeverSource
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: test
+connections:
+  - [source, 0, test_sink, 0]
+)";
+        TestSetup test;
+
+        std::atomic<std::size_t> receivedCount = 0;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=test"), [&receivedCount](const auto& acq) { receivedCount += acq.channelValue.size(); });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+        waitWhile([&] { return receivedCount < 10000UZ; });
+
+        AcquisitionTelemetry telemetry;
+        waitWhile([&] {
+            telemetry = test.acqWorker.telemetry();
+            return telemetry.pollerNotificationRate.value().empty() || telemetry.pollerNotificationRate.value()[0] <= 0.f;
+        });
+        expect(eq(telemetry.activeSubscriptions.value(), 1));
+        expect(eq(telemetry.pollerSignalName.value(), std::vector<std::string>{"test"}));
+        expect(eq(telemetry.pollerAcquisitionMode.value(), std::vector<std::string>{"continuous"}));
+        expect(eq(telemetry.pollerSubscriptions.value(), std::vector<std::int32_t>{1}));
+        expect(telemetry.pollerSampleRate.value()[0] > 0.f);
+        expect(telemetry.pollerBytesSerialised.value()[0] > 0);
+        expect(telemetry.reportInterval.value() > 0.f);
+        expect(telemetry.cycleDurationMax.value() >= telemetry.cycleDurationMean.value());
+        // one histogram per poller, with one bin more than there are bounds
+        expect(eq(telemetry.pollerLatencyHistogram.value().size(), telemetry.latencyBinBounds.value().size() + 1));
+        expect(std::accumulate(telemetry.pollerLatencyHistogram.value().begin(), telemetry.pollerLatencyHistogram.value().end(), std::int64_t{0}) > 0);
+    };
+
+    "Spectra"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      signal_name: count
+      sample_rate: 64
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, test_sink, 0]
+)";
+        TestSetup test;
+
+        constexpr std::size_t kFftSize = 64;
+        std::mutex            spectrumMutex;
+        AcquisitionSpectra    spectrum;
+        std::atomic<bool>     received = false;
+        test.subscribeClient<AcquisitionSpectra>(URI("mds://127.0.0.1:12345/GnuRadio/Spectra?channelNameFilter=count&fftSize=64&window=rectangular"), [&](const AcquisitionSpectra& reply) {
+            std::lock_guard lock(spectrumMutex);
+            spectrum = reply;
+            received = true;
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+        waitWhile([&] { return !received.load(); });
+
+        std::lock_guard lock(spectrumMutex);
+        expect(eq(spectrum.channelName.value(), "count"s));
+        expect(eq(spectrum.channelMagnitude.value().size(), kFftSize / 2 + 1));
+        expect(eq(spectrum.channelPhase.value().size(), kFftSize / 2 + 1));
+        expect(eq(spectrum.channelMagnitude_dimensions.value(), std::vector<std::int32_t>{1, static_cast<std::int32_t>(kFftSize / 2 + 1)}));
+        expect(eq(spectrum.channelMagnitude_labels.value(), std::vector<std::string>{"time", "frequency"}));
+        expect(eq(spectrum.channelMagnitude_dim2_labels.value().front(), 0.f));
+        expect(std::ranges::is_sorted(spectrum.channelMagnitude_dim2_labels.value()));
+        // the counter is a ramp with a positive mean, the DC component is at least the mean of 0..63 and dominates
+        expect(spectrum.channelMagnitude.value()[0] >= 31.5f);
+        expect(spectrum.channelMagnitude.value()[0] > spectrum.channelMagnitude.value()[1]);
+    };
+
+    "Trigger - tightly packed tags"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      sample_rate: 10
+      timing_tags:
+        - 40,notatrigger
+        - 50,hello,5000000000
+        - 60,ignoreme
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+      sample_rate: 10
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup                  test;
+
+        std::vector<float>       receivedData;
+        std::atomic<std::size_t> receivedCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=15"), [&receivedData, &receivedCount](const auto& acq) {
+            expect(acq.acqTriggerName.value() == "hello");
+            expect(eq(acq.acqTriggerTimeStamp.value(), 5'000'000'000));
+            expect(eq(acq.channelFirstSampleTimeStamp.value(), 4'500'000'000)); // 5 pre-trigger samples at 10 Hz
+            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedCount = receivedData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedCount < 20; });
+
+        expect(eq(receivedData, getIota(20, 45)));
+    };
+
+    "Trigger - sparse tags"_test = [] {
+        // Tests that tags detection and offsets work when the tag data is spread among multiple threads
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 10000000
+      timing_tags:
+        - 1000,notatrigger
+        - 800000,hello
+        - 900000,ignoreme
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup                  test;
+
+        std::vector<float>       receivedData;
+        std::atomic<std::size_t> receivedCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=15"), [&receivedData, &receivedCount](const auto& acq) {
+            expect(acq.acqTriggerName.value() == "hello");
+            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedCount = receivedData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedCount < 20; });
+
+        expect(eq(receivedData, getIota(20, 799995)));
+    };
+
+    "Trigger - subscriptions sharing a poller"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      timing_tags:
+        - 40,notatrigger
+        - 50,hello
+        - 60,ignoreme
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup                  test;
+
+        std::vector<float>       receivedWideData;
+        std::atomic<std::size_t> receivedWideCount = 0;
+        std::vector<float>       receivedNarrowData;
+        std::atomic<std::size_t> receivedNarrowCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=15"), [&receivedWideData, &receivedWideCount](const auto& acq) {
+            expect(acq.acqTriggerName.value() == "hello");
+            receivedWideData.insert(receivedWideData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedWideCount = receivedWideData.size();
+        });
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=2&postSamples=3"), [&receivedNarrowData, &receivedNarrowCount](const auto& acq) {
+            expect(acq.acqTriggerName.value() == "hello");
+            receivedNarrowData.insert(receivedNarrowData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedNarrowCount = receivedNarrowData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedWideCount < 20 || receivedNarrowCount < 5; });
+
+        expect(eq(receivedWideData, getIota(20, 45)));
+        expect(eq(receivedNarrowData, getIota(5, 48)));
+    };
+
+    "Trigger - wider subscription joining"_test = [] {
+        // the count pauses inside the window of the first trigger, so it is pending in the sink when the wider subscription joins
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      timing_tags:
+        - 50,hello
+        - 80,hello
+      pause_at: 52
+      pause_ms: 3000
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup test;
+
+        std::vector<float>       receivedNarrowData;
+        std::atomic<std::size_t> receivedNarrowCount = 0;
+        std::vector<float>       receivedWideData;
+        std::atomic<std::size_t> receivedWideCount = 0;
+        std::atomic<std::size_t> streamedCount     = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=2&postSamples=3"), [&receivedNarrowData, &receivedNarrowCount](const auto& acq) {
+            receivedNarrowData.insert(receivedNarrowData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedNarrowCount = receivedNarrowData.size();
+        });
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count"), [&streamedCount](const auto& acq) { streamedCount += acq.channelValue.size(); });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return streamedCount < 52; }); // the count paused, the trigger at 50 waits for its last post-trigger sample
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=15"), [&receivedWideData, &receivedWideCount](const auto& acq) {
+            receivedWideData.insert(receivedWideData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedWideCount = receivedWideData.size();
+        });
+
+        waitWhile([&] { return receivedNarrowCount < 10 || receivedWideCount < 20; });
+
+        auto expectedNarrow = getIota(5, 48);
+        std::ranges::copy(getIota(5, 78), std::back_inserter(expectedNarrow));
+        expect(eq(receivedNarrowData, expectedNarrow)); // nothing pending was dropped for the new poller
+        expect(eq(receivedWideData, getIota(20, 75)));  // the wider subscription only sees triggers after it joined
+    };
+
+    "Trigger - wakeup"_test = [] {
+        // with a rate this long, the dataset only arrives in time if the sink callback woke up the notify thread
+        constexpr auto             kRate = 10s;
+        constexpr std::string_view grc   = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      timing_tags:
+        - 50,hello
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup test({}, 1, kRate);
+
+        std::atomic<bool> received = false;
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&preSamples=5&postSamples=5"), [&received](const auto& acq) {
+            expect(eq(acq.channelValue.value(), getIota(10, 45)));
+            received = true;
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+        const auto flowGraphSet = std::chrono::steady_clock::now();
+
+        waitWhile([&] { return !received.load(); });
+        expect(std::chrono::steady_clock::now() - flowGraphSet < kRate / 2);
+    };
+
+    "Trigger - wakeup callback registration"_test = [] {
+        auto            signal = std::make_shared<opendigitizer::acq::detail::WakeupSignal>();
+        WakeupCallbacks callbacks(signal);
+        const PollerKey key{.mode = AcquisitionMode::Triggered, .signal_name = "count", .trigger_name = "hello"};
+
+        std::vector<std::function<void()>> registered; // fires the callbacks the way a sink would
+        auto                               registerWithSink = [&registered](auto callback) { registered.emplace_back([callback] { callback(0); }); };
+
+        const auto first = callbacks.registerCallback(key, registerWithSink);
+        expect(fatal(first != nullptr));
+        expect(fatal(eq(registered.size(), 1UZ)));
+        expect(!first->load());
+        expect(!signal->waitUntil(std::chrono::steady_clock::now()));
+
+        registered[0]();
+        expect(first->load());
+        expect(signal->waitUntil(std::chrono::steady_clock::now()));
+
+        // further pollers of the key share the callback
+        expect(callbacks.registerCallback(key, registerWithSink) == first);
+        expect(eq(registered.size(), 1UZ));
+
+        const auto other = callbacks.registerCallback(PollerKey{.mode = AcquisitionMode::Multiplexed, .signal_name = "count", .trigger_name = "hello"}, registerWithSink);
+        expect(fatal(other != nullptr));
+        expect(other != first);
+        expect(eq(registered.size(), 2UZ));
+    };
+
+    "Trigger - batched datasets"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      sample_rate: 10
+      timing_tags:
+        - 10,hello,1000000000
+        - 20,hello,2000000000
+        - 30,hello,3000000000
+        - 40,hello,4000000000
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+      sample_rate: 10
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup test;
+
+        std::vector<float>        receivedData;
+        std::vector<std::int32_t> receivedSegmentSizes;
+        std::vector<std::int64_t> receivedFirstSampleTimeStamps;
+        std::vector<std::int64_t> receivedTriggerTimeStamps;
+        std::atomic<std::size_t>  receivedUpdates = 0;
+        std::atomic<std::size_t>  receivedCount   = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=triggered&triggerNameFilter=hello&postSamples=5&maxBatchSize=10"), [&](const auto& acq) {
+            expect(eq(acq.batchFirstSampleTimeStamp.size(), acq.batchSegmentSize.size()));
+            expect(eq(acq.batchTriggerTimeStamp.size(), acq.batchSegmentSize.size()));
+            receivedSegmentSizes.insert(receivedSegmentSizes.end(), acq.batchSegmentSize.value().begin(), acq.batchSegmentSize.value().end());
+            receivedFirstSampleTimeStamps.insert(receivedFirstSampleTimeStamps.end(), acq.batchFirstSampleTimeStamp.value().begin(), acq.batchFirstSampleTimeStamp.value().end());
+            receivedTriggerTimeStamps.insert(receivedTriggerTimeStamps.end(), acq.batchTriggerTimeStamp.value().begin(), acq.batchTriggerTimeStamp.value().end());
+            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            ++receivedUpdates;
+            receivedCount = receivedData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedCount < 20; });
+
+        // all four datasets become available at once (after the delay), and are sent in fewer updates
+        expect(receivedUpdates.load() < 4UZ);
+        expect(eq(receivedSegmentSizes, std::vector<std::int32_t>{5, 5, 5, 5}));
+        // without pre-trigger samples, each dataset starts at its trigger
+        const std::vector<std::int64_t> expectedTimeStamps{1'000'000'000, 2'000'000'000, 3'000'000'000, 4'000'000'000};
+        expect(eq(receivedFirstSampleTimeStamps, expectedTimeStamps));
+        expect(eq(receivedTriggerTimeStamps, expectedTimeStamps));
+        std::vector<float> expectedData;
+        for (const float first : {10.f, 20.f, 30.f, 40.f}) {
+            const auto segment = getIota(5, first);
+            expectedData.insert(expectedData.end(), segment.begin(), segment.end());
+        }
+        expect(eq(receivedData, expectedData));
+    };
+
+    "Multiplexed"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      signal_unit: A unit
+      sample_rate: 10
+      timing_tags:
+        - 30,hello
+        - 50,start,5000000000
+        - 70,hello
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        std::vector<SignalEntry>   lastDnsEntries;
+        TestSetup                  test([&lastDnsEntries](auto entries) {
+            if (!entries.empty()) {
+                lastDnsEntries = std::move(entries);
+            }
+        });
+
+        std::vector<float>       receivedData;
+        std::atomic<std::size_t> receivedCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=multiplexed&triggerNameFilter=start"), [&receivedData, &receivedCount](const auto& acq) {
+            expect(acq.acqTriggerName.value() == "start");
+            expect(eq(acq.acqTriggerTimeStamp.value(), 5'000'000'000));
+            expect(eq(acq.channelFirstSampleTimeStamp.value(), 5'000'000'000)); // the window starts at the trigger
+            expect(eq(acq.channelSampleInterval.value(), 0.1f));
+            expect(eq(acq.channelTimeBase.size(), 0UZ));
+            receivedData.insert(receivedData.end(), acq.channelValue.begin(), acq.channelValue.end());
+            receivedCount = receivedData.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedCount < 20; });
+
+        expect(eq(receivedData, getIota(20, 50)));
+        expect(eq(lastDnsEntries.size(), 1UZ));
+        if (!lastDnsEntries.empty()) {
+            expect(eq(lastDnsEntries[0].name, "count"sv));
+            expect(eq(lastDnsEntries[0].unit, "A unit"sv));
+            expect(eq(lastDnsEntries[0].sample_rate, 10.f));
+        }
+    };
+
+    "Snapshot"_test = [] {
         constexpr std::string_view grc = R"(
 blocks:
   - name: count
@@ -584,6 +1566,51 @@ connections:
         }
     };
 
+    "Snapshot - multiple delays"_test = [] {
+        constexpr std::string_view grc = R"(
+blocks:
+  - name: count
+    id: CountSource
+    parameters:
+      n_samples: 100
+      sample_rate: 10
+      timing_tags:
+        - 40,hello
+        - 50,shoot
+        - 60,world
+  - name: delay
+    id: gr::testing::Delay
+    parameters:
+      delay_ms: 600
+  - name: test_sink
+    id: gr::basic::DataSink
+    parameters:
+      signal_name: count
+connections:
+  - [count, 0, delay, 0]
+  - [delay, 0, test_sink, 0]
+)";
+        TestSetup test;
+
+        std::vector<std::vector<float>> receivedUpdates;
+        std::atomic<std::size_t>        receivedCount = 0;
+
+        test.subscribeClient(URI("mds://127.0.0.1:12345/GnuRadio/Acquisition?channelNameFilter=count&acquisitionModeFilter=snapshot&triggerNameFilter=shoot&snapshotDelays=0,1000000000,3000000000,-500000000"), [&receivedUpdates, &receivedCount](const auto& acq) {
+            expect(eq(acq.acqTriggerName.value(), "shoot"sv));
+            receivedUpdates.emplace_back(acq.channelValue.begin(), acq.channelValue.end());
+            receivedCount = receivedUpdates.size();
+        });
+
+        std::this_thread::sleep_for(50ms);
+        test.setGrc(grc);
+
+        waitWhile([&] { return receivedCount == 0; });
+
+        // all delays in one update, in the requested order: trigger + delay * sample_rate = 50 + {0, 10, 30, -5}
+        expect(eq(receivedUpdates.size(), 1UZ));
+        expect(eq(receivedUpdates.front(), std::vector{50.f, 60.f, 80.f, 45.f}));
+    };
+
     "Flow graph handling - Unknown block"_test = [] {
         constexpr std::string_view grc = R"(
 blocks:
@@ -5,11 +5,17 @@
 #include <zmq/ZmqUtils.hpp>
 
 #include <algorithm>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <set>
 #include <thread>
 
 #include "FAIR/DeviceNameHelper.hpp"
 #include "dashboard/dashboardWorker.hpp"
+#include "gnuradio/GnuRadioRecorderWorker.hpp"
+#include "gnuradio/GnuRadioSpectraWorker.hpp"
 #include "gnuradio/GnuRadioWorker.hpp"
 #include "rest/fileserverRestBackend.hpp"
 
@@ -86,6 +92,118 @@ void registerTestBlocks(Registry& registry) {
     }
 #pragma GCC diagnostic pop
 }
+
+/**
+ * Keeps the DNS in sync with the signals of the flow graph. The acquisition worker only hands over its latest signal list; the
+ * registrar's thread compares it with what is registered and sends the differences in batches of at most batchSize signals. A list
+ * arriving while batches are sent supersedes the rest of the previous one, so only the newest state is ever sent.
+ */
+class DnsSignalRegistrar {
+    using SignalEntry = opendigitizer::acq::SignalEntry;
+    using DnsEntry    = opencmw::service::dns::Entry;
+
+    opencmw::service::dns::DnsClient&                        _dnsClient;
+    std::function<std::vector<DnsEntry>(const SignalEntry&)> _dnsEntriesForSignal;
+    std::size_t                                              _batchSize;
+    std::mutex                                               _mutex;
+    std::condition_variable_any                              _pendingChanged;
+    std::optional<std::vector<SignalEntry>>                  _pending; // guarded by _mutex
+    std::set<SignalEntry>                                    _registered;
+    std::jthread                                             _thread;
+
+public:
+    DnsSignalRegistrar(opencmw::service::dns::DnsClient& dnsClient, std::function<std::vector<DnsEntry>(const SignalEntry&)> dnsEntriesForSignal, std::size_t batchSize) : _dnsClient(dnsClient), _dnsEntriesForSignal(std::move(dnsEntriesForSignal)), _batchSize(std::max(batchSize, 1UZ)) {
+        _thread = std::jthread([this](std::stop_token stoken) { run(stoken); });
+    }
+
+    /// Replaces the signals to be registered, called from the acquisition worker's notify thread
+    void update(std::vector<SignalEntry> signals) {
+        {
+            std::lock_guard lock(_mutex);
+            _pending = std::move(signals);
+        }
+        _pendingChanged.notify_one();
+    }
+
+    /// Stops sending, to be called before the DNS client is stopped
+    void stop() {
+        _thread.request_stop();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+private:
+    std::optional<std::vector<SignalEntry>> takePending() {
+        std::lock_guard lock(_mutex);
+        return std::exchange(_pending, std::nullopt);
+    }
+
+    [[nodiscard]] bool hasPending() {
+        std::lock_guard lock(_mutex);
+        return _pending.has_value();
+    }
+
+    void run(std::stop_token stoken) {
+        while (!stoken.stop_requested()) {
+            {
+                std::unique_lock lock(_mutex);
+                if (!_pendingChanged.wait(lock, stoken, [this] { return _pending.has_value(); })) {
+                    return;
+                }
+            }
+            auto signals = takePending();
+            if (!signals) {
+                continue;
+            }
+            std::ranges::sort(*signals);
+            const auto [last, end] = std::ranges::unique(*signals);
+            signals->erase(last, end);
+
+            std::vector<SignalEntry> toUnregister;
+            std::ranges::set_difference(_registered, *signals, std::back_inserter(toUnregister));
+            std::vector<SignalEntry> toRegister;
+            std::ranges::set_difference(*signals, _registered, std::back_inserter(toRegister));
+
+            send(toUnregister, false, stoken);
+            send(toRegister, true, stoken);
+        }
+    }
+
+    /// Sends the (un)registrations in batches until done or superseded by a newer signal list
+    void send(std::span<const SignalEntry> signals, bool doRegister, const std::stop_token& stoken) {
+        for (auto batch = signals; !batch.empty() && !stoken.stop_requested() && !hasPending(); batch = batch.subspan(std::min(_batchSize, batch.size()))) {
+            const auto            batchSignals = batch.first(std::min(_batchSize, batch.size()));
+            std::vector<DnsEntry> entries;
+            entries.reserve(batchSignals.size());
+            for (const auto& signal : batchSignals) {
+                auto dns = _dnsEntriesForSignal(signal);
+                entries.insert(entries.end(), std::make_move_iterator(dns.begin()), std::make_move_iterator(dns.end()));
+            }
+            if (doRegister) {
+                _dnsClient.registerSignals(std::move(entries));
+                _registered.insert(batchSignals.begin(), batchSignals.end());
+            } else {
+                _dnsClient.unregisterSignals(std::move(entries));
+                for (const auto& signal : batchSignals) {
+                    _registered.erase(signal);
+                }
+            }
+        }
+    }
+};
+
+/// Synthetic signals for load tests of the DNS registration, named after test devices (with a numeric suffix once those run out)
+std::vector<opendigitizer::acq::SignalEntry> loadTestSignals(std::size_t count) {
+    std::vector<opendigitizer::acq::SignalEntry> signals;
+    signals.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto info  = fair::getDeviceInfo(fair::testDeviceNames[i % fair::testDeviceNames.size()]);
+        const auto round = i / fair::testDeviceNames.size();
+        signals.push_back({.name = round == 0 ? std::string(info.name) : fmt::format("{}_{}", info.name, round), .unit = "TEST unit", .sample_rate = 1.f});
+    }
+    return signals;
+}
 } // namespace
 
 using namespace opencmw::majordomo;
@@ -138,19 +256,13 @@ connections:
     dns::DnsWorkerType dns_worker{broker, dns::DnsHandler{}};
     std::jthread       dnsThread([&dns_worker] { dns_worker.run(); });
 
-    // dashboard worker (mock)
-    using DsWorker = DashboardWorker<"/dashboards", description<"Provides R/W access to the dashboard as a yaml serialized string">>;
-    DsWorker     dashboardWorker(broker);
-    std::jthread dashboardWorkerThread([&dashboardWorker] { dashboardWorker.run(); });
-
-    using GrAcqWorker = GnuRadioAcquisitionWorker<"/GnuRadio/Acquisition", description<"Provides data from a GnuRadio flow graph execution">>;
-    using GrFgWorker  = GnuRadioFlowGraphWorker<GrAcqWorker, "/flowgraph", description<"Provides access to the GnuRadio flow graph">>;
-    gr::BlockRegistry registry;
-    registerTestBlocks(registry);
-    gr::PluginLoader pluginLoader(registry, {});
-    GrAcqWorker      grAcqWorker(broker, &pluginLoader, std::chrono::milliseconds(50));
-    GrFgWorker       grFgWorker(broker, &pluginLoader, {grc, {}}, grAcqWorker);
+    // dashboard worker, dashboards are persisted in OPENDIGITIZER_DASHBOARD_DIR (kept in memory only if empty)
+    using DsWorker                 = DashboardWorker<"/dashboards", description<"Provides R/W access to the dashboard as a yaml serialized string">>;
+    const std::string dashboardDir = Digitizer::getValueFromEnv<std::string>("OPENDIGITIZER_DASHBOARD_DIR", "dashboards");
+    DsWorker          dashboardWorker(broker, dashboardDir.empty() ? std::nullopt : std::optional<std::filesystem::path>(dashboardDir));
+    std::jthread      dashboardWorkerThread([&dashboardWorker] { dashboardWorker.run(); });
 
+    // declared before the acquisition worker, which publishes its signals until it is destroyed
     const opencmw::zmq::Context                               zctx{};
     std::vector<std::unique_ptr<opencmw::client::ClientBase>> clients;
     clients.emplace_back(std::make_unique<opencmw::client::MDClientCtx>(zctx, 20ms, ""));
@@ -161,31 +273,9 @@ connections:
 
     const auto restUrl = settings.serviceUrl().build();
 
-    std::vector<SignalEntry> registeredSignals;
-    grAcqWorker.setUpdateSignalEntriesCallback([&registeredSignals, &dns_client, &restUrl](std::vector<SignalEntry> signals) {
-        if (::getenv("OPENDIGITIZER_LOAD_TEST_SIGNALS")) {
-            size_t x = 0;
-            for (auto& i : fair::testDeviceNames) {
-                if (x >= 12) {
-                    break;
-                }
-                const auto  info = fair::getDeviceInfo(i);
-                SignalEntry entry;
-                entry.name        = info.name;
-                entry.sample_rate = 1.f;
-                entry.unit        = "TEST unit";
-                signals.push_back(entry);
-                x++;
-            }
-        }
-
-        std::ranges::sort(signals);
-        std::vector<SignalEntry> toUnregister;
-        std::ranges::set_difference(registeredSignals, signals, std::back_inserter(toUnregister));
-        std::vector<SignalEntry> toRegister;
-        std::ranges::set_difference(signals, registeredSignals, std::back_inserter(toRegister));
-
-        auto dnsEntriesForSignal = [&restUrl](const SignalEntry& entry) {
+    DnsSignalRegistrar dnsRegistrar(
+        dns_client,
+        [&restUrl](const SignalEntry& entry) {
             // TODO publish acquisition modes other than streaming?
             // TODO mdp not functional (not implemented in worker)
             return std::vector{
@@ -193,33 +283,65 @@ connections:
                 // dns::Entry{"mdp", *restUrl.hostName(), 12345, "/GnuRadio/Acquisition", "", entry.name, entry.unit, entry.sample_rate, "STREAMING"},
                 // dns::Entry{"mds", *restUrl.hostName(), 12345, "/GnuRadio/Acquisition", "", entry.name, entry.unit, entry.sample_rate, "STREAMING"}
             };
-        };
-        std::vector<dns::Entry> toUnregisterEntries;
-        for (const auto& signal : toUnregister) {
-            auto dns = dnsEntriesForSignal(signal);
-            toUnregisterEntries.insert(toUnregisterEntries.end(), dns.begin(), dns.end());
-        }
-        dns_client.unregisterSignals(std::move(toUnregisterEntries));
+        },
+        Digitizer::getValueFromEnv<std::size_t>("OPENDIGITIZER_DNS_BATCH_SIZE", 1000UZ));
 
-        std::vector<dns::Entry> toRegisterEntries;
-        for (const auto& signal : toRegister) {
-            auto dns = dnsEntriesForSignal(signal);
-            toRegisterEntries.insert(toRegisterEntries.end(), dns.begin(), dns.end());
+    // synthetic signals registered in addition to those of the flow graph if OPENDIGITIZER_LOAD_TEST_SIGNALS is set, to measure the
+    // registration cost at scale with OPENDIGITIZER_LOAD_TEST_SIGNAL_COUNT signals
+    const auto testSignals = ::getenv("OPENDIGITIZER_LOAD_TEST_SIGNALS") ? loadTestSignals(Digitizer::getValueFromEnv<std::size_t>("OPENDIGITIZER_LOAD_TEST_SIGNAL_COUNT", 12UZ)) : std::vector<SignalEntry>{};
+
+    using GrAcqWorker = GnuRadioAcquisitionWorker<"/GnuRadio/Acquisition", description<"Provides data from a GnuRadio flow graph execution">>;
+    using GrFgWorker  = GnuRadioFlowGraphWorker<GrAcqWorker, "/flowgraph", description<"Provides access to the GnuRadio flow graph">>;
+    using GrTmWorker  = GnuRadioTelemetryWorker<GrAcqWorker, "/GnuRadio/Telemetry", description<"Provides throughput and latency statistics of the acquisition worker">>;
+    using GrSpWorker  = GnuRadioSpectraWorker<GrAcqWorker, "/GnuRadio/Spectra", description<"Provides magnitude and phase spectra of the flow graph's signals">>;
+    using GrRcWorker  = GnuRadioRecorderWorker<"/GnuRadio/Recording", description<"Provides time ranges and trigger windows of the recorded signals">>;
+    gr::BlockRegistry registry;
+    registerTestBlocks(registry);
+    gr::PluginLoader pluginLoader(registry, {});
+    // number of threads servicing the acquisition pollers (and serialising/sending their replies) in parallel
+    const auto       pollerThreadCount = Digitizer::getValueFromEnv<std::size_t>("OPENDIGITIZER_POLLER_THREADS", 1UZ);
+    GrAcqWorker      grAcqWorker(broker, &pluginLoader, std::chrono::milliseconds(50), pollerThreadCount);
+    GrFgWorker       grFgWorker(broker, &pluginLoader, {grc, {}}, grAcqWorker);
+    GrTmWorker       grTmWorker(broker, grAcqWorker);
+    GrSpWorker       grSpWorker(broker, grAcqWorker, std::chrono::milliseconds(50));
+
+    // history retained per signal for backfilling new streaming subscriptions, 0 disables it
+    const auto historySeconds  = Digitizer::getValueFromEnv<std::size_t>("OPENDIGITIZER_HISTORY_SECONDS", 0UZ);
+    const auto historyBudgetMb = Digitizer::getValueFromEnv<std::size_t>("OPENDIGITIZER_HISTORY_BUDGET_MB", 64UZ);
+    grAcqWorker.setHistoryRetention(std::chrono::seconds(historySeconds), historyBudgetMb << 20);
+
+    // signals recorded to disk, comma-separated
+    RecorderSettings  recorderSettings{.directory = Digitizer::getValueFromEnv<std::string>("OPENDIGITIZER_RECORD_DIR", "recordings")};
+    const std::string recordedSignals = Digitizer::getValueFromEnv<std::string>("OPENDIGITIZER_RECORD_SIGNALS", "");
+    for (const auto signal : recordedSignals | std::views::split(',')) {
+        if (!signal.empty()) {
+            recorderSettings.signals.emplace_back(signal.begin(), signal.end());
         }
-        dns_client.registerSignals(std::move(toRegisterEntries));
-        registeredSignals = std::move(signals);
+    }
+    GrRcWorker grRcWorker(broker, std::move(recorderSettings), std::chrono::milliseconds(50));
+
+    grAcqWorker.setUpdateSignalEntriesCallback([&dnsRegistrar, &testSignals](std::vector<SignalEntry> signals) {
+        signals.insert(signals.end(), testSignals.begin(), testSignals.end());
+        dnsRegistrar.update(std::move(signals));
     });
 
     std::jthread grAcqWorkerThread([&grAcqWorker] { grAcqWorker.run(); });
     std::jthread grFgWorkerThread([&grFgWorker] { grFgWorker.run(); });
+    std::jthread grTmWorkerThread([&grTmWorker] { grTmWorker.run(); });
+    std::jthread grSpWorkerThread([&grSpWorker] { grSpWorker.run(); });
+    std::jthread grRcWorkerThread([&grRcWorker] { grRcWorker.run(); });
 
     brokerThread.join();
     restThread.join();
 
+    dnsRegistrar.stop();
     client.stop();
 
     dnsThread.join();
     dashboardWorkerThread.join();
     grAcqWorkerThread.join();
     grFgWorkerThread.join();
+    grTmWorkerThread.join();
+    grSpWorkerThread.join();
+    grRcWorkerThread.join();
 }
@@ -1,15 +1,461 @@
 #include <majordomo/base64pp.hpp>
 #include <majordomo/RestBackend.hpp>
 
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef OPENDIGITIZER_GZIP_ASSETS
+#include <zlib.h>
+#endif
+
 using namespace opencmw::majordomo;
 
 namespace sfs = std::filesystem;
 
+namespace detail {
+
+/// Strong entity tag derived from the content (FNV-1a), so it stays stable across restarts and only changes with the data
+inline std::string entityTag(std::string_view content) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const char c : content) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3ULL;
+    }
+    return fmt::format("\"{:016x}-{:x}\"", hash, content.size());
+}
+
+inline std::string_view trim(std::string_view sv) {
+    const auto first = sv.find_first_not_of(" \t");
+    return first == std::string_view::npos ? std::string_view{} : sv.substr(first, sv.find_last_not_of(" \t") - first + 1);
+}
+
+/// Whether an If-None-Match header value matches the entity tag (weak comparison, as required for If-None-Match)
+inline bool entityTagMatches(std::string_view ifNoneMatch, std::string_view etag) {
+    auto opaque = [](std::string_view tag) { return tag.starts_with("W/") ? tag.substr(2) : tag; };
+    while (!ifNoneMatch.empty()) {
+        const auto comma = ifNoneMatch.find(',');
+        const auto tag   = trim(ifNoneMatch.substr(0, comma));
+        if (tag == "*" || (!tag.empty() && opaque(tag) == opaque(etag))) {
+            return true;
+        }
+        ifNoneMatch = comma == std::string_view::npos ? std::string_view{} : ifNoneMatch.substr(comma + 1);
+    }
+    return false;
+}
+
+/// Whether at least one of the requested byte ranges (first, last; -1 if omitted) overlaps content of the given size
+inline bool rangesSatisfiable(const httplib::Ranges& ranges, std::size_t size) {
+    return std::ranges::any_of(ranges, [size](const auto& range) {
+        const auto [first, last] = range;
+        return first >= 0 ? static_cast<std::size_t>(first) < size : last > 0 && size > 0;
+    });
+}
+
+struct ContentTypeInfo {
+    std::string_view extension;
+    std::string_view content_type;
+    bool             compressible;
+};
+
+inline constexpr std::array contentTypes{
+    ContentTypeInfo{".html", "text/html", true},
+    ContentTypeInfo{".js", "application/javascript", true},
+    ContentTypeInfo{".mjs", "application/javascript", true},
+    ContentTypeInfo{".wasm", "application/wasm", true},
+    ContentTypeInfo{".css", "text/css", true},
+    ContentTypeInfo{".json", "application/json", true},
+    ContentTypeInfo{".map", "application/json", true},
+    ContentTypeInfo{".svg", "image/svg+xml", true},
+    ContentTypeInfo{".txt", "text/plain", true},
+    ContentTypeInfo{".mustache", "text/html", true},
+    ContentTypeInfo{".yml", "application/yaml", true},
+    ContentTypeInfo{".yaml", "application/yaml", true},
+    ContentTypeInfo{".grc", "application/yaml", true},
+    ContentTypeInfo{".data", "application/octet-stream", true},
+    ContentTypeInfo{".ico", "image/x-icon", true},
+    ContentTypeInfo{".png", "image/png", false},
+    ContentTypeInfo{".jpg", "image/jpeg", false},
+    ContentTypeInfo{".jpeg", "image/jpeg", false},
+    ContentTypeInfo{".gif", "image/gif", false},
+    ContentTypeInfo{".woff", "font/woff", false},
+    ContentTypeInfo{".woff2", "font/woff2", false},
+    ContentTypeInfo{".ttf", "font/ttf", true},
+};
+
+inline ContentTypeInfo contentTypeForFilename(std::string_view path) {
+    const auto it = std::ranges::find_if(contentTypes, [path](const auto& info) { return path.ends_with(info.extension); });
+    return it != contentTypes.end() ? *it : ContentTypeInfo{"", "application/octet-stream", false};
+}
+
+/// Content codings that can be served precompressed, in order of preference, with the file name extension of their variants
+inline constexpr std::array<std::pair<std::string_view, std::string_view>, 3> precompressedEncodings{{{"br", ".br"}, {"zstd", ".zst"}, {"gzip", ".gz"}}};
+
+/// Quality value (RFC 9110) an Accept-Encoding header value assigns to the content coding, 0 if it is not acceptable
+inline double encodingQuality(std::string_view acceptEncoding, std::string_view encoding) {
+    std::optional<double> wildcard;
+    for (const auto part : acceptEncoding | std::views::split(',')) {
+        const std::string_view item(part.begin(), part.end());
+        const auto             semicolon = item.find(';');
+        const auto             coding    = trim(item.substr(0, semicolon));
+        double                 quality   = 1.0;
+        if (semicolon != std::string_view::npos) {
+            const auto parameters = trim(item.substr(semicolon + 1));
+            if (parameters.starts_with("q=") || parameters.starts_with("Q=")) {
+                std::from_chars(parameters.data() + 2, parameters.data() + parameters.size(), quality);
+            }
+        }
+        if (std::ranges::equal(coding, encoding, [](char lhs, char rhs) { return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs)); })) {
+            return quality;
+        }
+        if (coding == "*") {
+            wildcard = quality;
+        }
+    }
+    return wildcard.value_or(0.0);
+}
+
+/**
+ * A file on disk that is read per request instead of being held in memory. It stays open (and thus readable even if it is
+ * replaced) as long as a response uses it. Its size is that at opening; reads of a file truncated since then fail instead of
+ * faulting, as reading from a memory mapping would.
+ */
+class OpenFile {
+    int         _fd   = -1;
+    std::size_t _size = 0;
+
+public:
+    static constexpr std::size_t kReadChunkSize = 256 << 10;
+
+    explicit OpenFile(const sfs::path& filePath) : _fd(::open(filePath.c_str(), O_RDONLY | O_CLOEXEC)) {
+        struct stat status{};
+        if (_fd >= 0 && ::fstat(_fd, &status) == 0) {
+            _size = static_cast<std::size_t>(status.st_size);
+            ::posix_fadvise(_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
+    }
+
+    OpenFile(const OpenFile&)            = delete;
+    OpenFile& operator=(const OpenFile&) = delete;
+
+    ~OpenFile() {
+        if (_fd >= 0) {
+            ::close(_fd);
+        }
+    }
+
+    [[nodiscard]] bool        isOpen() const noexcept { return _fd >= 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    /// Reads up to kReadChunkSize bytes at offset into buffer, false if nothing could be read
+    bool read(std::size_t offset, std::size_t length, std::string& buffer) const {
+        buffer.resize(std::min(length, kReadChunkSize));
+        const auto n = ::pread(_fd, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+        if (n <= 0) {
+            return false;
+        }
+        buffer.resize(static_cast<std::size_t>(n));
+        return true;
+    }
+};
+
+#ifdef OPENDIGITIZER_GZIP_ASSETS
+/// Compresses the data into the gzip format, nullopt if zlib fails
+inline std::optional<std::string> gzipCompress(std::string_view data) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16 /* gzip wrapper */, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::nullopt;
+    }
+    std::string compressed(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in  = static_cast<uInt>(data.size());
+    stream.next_out  = reinterpret_cast<Bytef*>(compressed.data());
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    const auto result = deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END ? std::optional(std::move(compressed)) : std::nullopt;
+}
+#endif
+
+/// One encoding of a served file
+struct AssetRepresentation {
+    std::string                     encoding{}; // Content-Encoding, empty for the identity
+    std::string                     storage{};  // content read from disk or compressed at load time
+    std::string_view                external{}; // content embedded into the binary, used if storage is not owned
+    std::shared_ptr<const OpenFile> file{};     // content read per request, used instead of both for large files on disk
+    bool                            owned = false;
+    std::string                     etag{};
+
+    /// The content held in memory, empty for files read per request
+    [[nodiscard]] std::string_view content() const noexcept { return owned ? std::string_view(storage) : external; }
+    [[nodiscard]] std::size_t      size() const noexcept { return file ? file->size() : content().size(); }
+
+    /// Writes (a part of) the requested bytes to the sink, buffer is used to read files on disk; false if the file was truncated
+    bool write(std::size_t offset, std::size_t length, httplib::DataSink& sink, std::string& buffer) const {
+        if (file) {
+            if (!file->read(offset, length, buffer)) {
+                return false;
+            }
+            sink.write(buffer.data(), buffer.size());
+            return true;
+        }
+        const auto data = content();
+        sink.write(data.data() + offset, std::min(length, data.size() - offset));
+        return true;
+    }
+};
+
+/// Content of a served file, immutable once loaded and shared between all responses sending it
+struct CachedAsset {
+    std::vector<AssetRepresentation> representations; // the identity first, then precompressed variants in order of preference
+    ContentTypeInfo                  content_type;
+    bool                             on_disk = false;
+    sfs::file_time_type              modified_time;
+    std::uintmax_t                   file_size = 0;
+
+    /// Files on disk are only cached if all of their representations are held in memory
+    [[nodiscard]] bool streamed() const noexcept {
+        return std::ranges::any_of(representations, [](const auto& representation) { return representation.file != nullptr; });
+    }
+
+    /// Heap memory held by the representations
+    [[nodiscard]] std::size_t heapSize() const noexcept {
+        std::size_t size = 0;
+        for (const auto& representation : representations) {
+            size += representation.storage.size();
+        }
+        return size;
+    }
+
+    /// The representation to send for the request's Accept-Encoding, falling back to the identity
+    [[nodiscard]] const AssetRepresentation& select(std::string_view acceptEncoding) const {
+        const AssetRepresentation* selected = &representations.front();
+        double                     quality  = 0.0;
+        for (const auto& representation : representations | std::views::drop(1)) {
+            if (const auto q = encodingQuality(acceptEncoding, representation.encoding); q > quality) {
+                selected = &representation;
+                quality  = q;
+            }
+        }
+        return *selected;
+    }
+};
+
+/**
+ * Caches the files served from the (embedded) virtual file system and the server root. Embedded files are referenced in place
+ * and always cached. Files on disk (e.g. the UI bundle) are read once and reloaded only when their modification time or size
+ * changes, so repeated requests for the same file neither touch the disk beyond a stat nor copy the content; they are cached up to
+ * kCacheBudget bytes in total, evicting the least recently used ones. Files of kMinStreamedSize and more (e.g. recorded data) are
+ * not cached but opened per request and read in chunks while the response is sent (OpenFile), so they take no more memory than
+ * a chunk however large they are; their ETag derives from modification time and size rather than from hashing the content.
+ *
+ * Precompressed variants ("<file>.br", "<file>.zst", "<file>.gz", e.g. generated by the build) are picked up next to each file; on disk
+ * only if they are not older than the file itself. Compressible files without a gzip variant are gzipped once at load time if zlib
+ * support is built in (OPENDIGITIZER_GZIP_ASSETS).
+ */
+template<typename VirtualFS>
+class AssetCache {
+    static constexpr std::size_t kMinCompressedSize = 1024;      // smaller files are not worth the Content-Encoding
+    static constexpr std::size_t kMinStreamedSize   = 16 << 20;  // larger files are read per request and not compressed at load time
+    static constexpr std::size_t kCacheBudget       = 128 << 20; // heap memory of the cached files on disk
+
+    struct CacheEntry {
+        std::shared_ptr<const CachedAsset> asset;
+        std::size_t                        heap_size = 0;
+        mutable std::atomic<std::uint64_t> last_used = 0; // value of _useCounter at the last lookup
+    };
+
+    const VirtualFS&                            _vfs;
+    sfs::path                                   _serverRoot;
+    std::mutex                                  _loadMutex;
+    mutable std::shared_mutex                   _mutex;
+    std::unordered_map<std::string, CacheEntry> _assets;          // by request path, guarded by _mutex
+    std::size_t                                 _cachedBytes = 0; // heap size of the cached files, guarded by _mutex
+    mutable std::atomic<std::uint64_t>          _useCounter  = 0;
+
+public:
+    AssetCache(const VirtualFS& vfs, sfs::path serverRoot) : _vfs(vfs), _serverRoot(std::move(serverRoot)) {}
+
+    /**
+     * Returns the current content for the request path, or nullptr if there is no such file. Files on disk are re-read when their
+     * modification time or size changed; requests with Cache-Control: no-cache are served from the cache as well, their
+     * revalidation is the stat done here.
+     */
+    std::shared_ptr<const CachedAsset> find(const std::string& path) {
+        if (auto cached = lookup(path); cached && (!cached->on_disk || isCurrent(*cached, path))) {
+            return cached;
+        }
+
+        // loads are serialised, so a burst of requests for a file that is not cached yet reads (and compresses) it only once
+        std::lock_guard loadLock(_loadMutex);
+        if (auto cached = lookup(path); cached && (!cached->on_disk || isCurrent(*cached, path))) {
+            return cached;
+        }
+        auto loaded = _vfs.is_file(path) ? loadEmbedded(path) : loadFromDisk(path);
+
+        std::unique_lock lock(_mutex);
+        if (const auto it = _assets.find(path); it != _assets.end()) {
+            _cachedBytes -= it->second.heap_size;
+            _assets.erase(it);
+        }
+        if (loaded && !loaded->streamed()) {
+            auto& entry     = _assets[path];
+            entry.asset     = loaded;
+            entry.heap_size = loaded->on_disk ? loaded->heapSize() : 0UZ; // embedded files are kept, whatever their gzipped variants take
+            entry.last_used = ++_useCounter;
+            _cachedBytes += entry.heap_size;
+            evictOverBudget();
+        }
+        return loaded;
+    }
+
+private:
+    std::shared_ptr<const CachedAsset> lookup(const std::string& path) const {
+        std::shared_lock lock(_mutex);
+        const auto       it = _assets.find(path);
+        if (it == _assets.end()) {
+            return nullptr;
+        }
+        it->second.last_used.store(++_useCounter, std::memory_order_relaxed);
+        return it->second.asset;
+    }
+
+    /// Drops the least recently used files on disk until the cache fits its budget, called with _mutex held
+    void evictOverBudget() {
+        while (_cachedBytes > kCacheBudget) {
+            auto oldest = _assets.end();
+            for (auto it = _assets.begin(); it != _assets.end(); ++it) {
+                if (it->second.heap_size > 0 && (oldest == _assets.end() || it->second.last_used < oldest->second.last_used)) {
+                    oldest = it;
+                }
+            }
+            _cachedBytes -= oldest->second.heap_size;
+            _assets.erase(oldest);
+        }
+    }
+
+    sfs::path filePathFor(std::string_view path) const { return _serverRoot / path.substr(std::min(path.find_first_not_of('/'), path.size())); }
+
+    bool isCurrent(const CachedAsset& cached, std::string_view path) const {
+        std::error_code ec;
+        const auto      filePath = filePathFor(path);
+        return sfs::last_write_time(filePath, ec) == cached.modified_time && !ec && sfs::file_size(filePath, ec) == cached.file_size && !ec;
+    }
+
+    static std::optional<AssetRepresentation> readFile(const sfs::path& filePath, std::uintmax_t size, sfs::file_time_type modified) {
+        AssetRepresentation representation;
+        if (size >= kMinStreamedSize) {
+            representation.file = std::make_shared<const OpenFile>(filePath);
+            if (!representation.file->isOpen()) {
+                return std::nullopt;
+            }
+            representation.etag = fmt::format("\"{:x}-{:x}\"", static_cast<std::uint64_t>(modified.time_since_epoch().count()), representation.file->size());
+            return representation;
+        }
+        std::ifstream inFile(filePath, std::ios::binary);
+        representation.storage.resize(size);
+        representation.owned = true;
+        if (!inFile.read(representation.storage.data(), static_cast<std::streamsize>(size))) {
+            return std::nullopt;
+        }
+        return representation;
+    }
+
+    std::shared_ptr<const CachedAsset> loadEmbedded(const std::string& path) const {
+        // the virtual file system serves data embedded into the binary, which lives as long as the process
+        auto embedded = [this](const std::string& filePath) {
+            auto file = _vfs.open(filePath);
+            return std::string_view(file.begin(), file.end());
+        };
+        auto asset = std::make_shared<CachedAsset>();
+        asset->representations.push_back({.external = embedded(path)});
+        for (const auto& [encoding, extension] : precompressedEncodings) {
+            if (const auto variantPath = path + std::string(extension); _vfs.is_file(variantPath)) {
+                asset->representations.push_back({.encoding = std::string(encoding), .external = embedded(variantPath)});
+            }
+        }
+        finishLoad(*asset, path);
+        return asset;
+    }
+
+    std::shared_ptr<const CachedAsset> loadFromDisk(std::string_view path) const {
+        const auto filePath = filePathFor(path);
+        auto       asset    = std::make_shared<CachedAsset>();
+
+        std::error_code ec;
+        asset->on_disk       = true;
+        asset->modified_time = sfs::last_write_time(filePath, ec);
+        asset->file_size     = ec ? 0 : sfs::file_size(filePath, ec);
+        if (ec || !sfs::is_regular_file(filePath, ec)) {
+            return nullptr;
+        }
+        auto identity = readFile(filePath, asset->file_size, asset->modified_time);
+        if (!identity) {
+            return nullptr;
+        }
+        asset->representations.push_back(std::move(*identity));
+
+        for (const auto& [encoding, extension] : precompressedEncodings) {
+            auto       variantPath = filePath;
+            const auto modified    = sfs::last_write_time(variantPath += extension, ec);
+            if (ec || modified < asset->modified_time || !sfs::is_regular_file(variantPath, ec)) {
+                continue; // missing or stale
+            }
+            if (const auto size = sfs::file_size(variantPath, ec); !ec) {
+                if (auto variant = readFile(variantPath, size, modified)) {
+                    variant->encoding = encoding;
+                    asset->representations.push_back(std::move(*variant));
+                }
+            }
+        }
+        finishLoad(*asset, path);
+        return asset;
+    }
+
+    static void finishLoad(CachedAsset& asset, std::string_view path) {
+        asset.content_type = contentTypeForFilename(path);
+#ifdef OPENDIGITIZER_GZIP_ASSETS
+        const auto identity = asset.representations.front().content();
+        if (asset.content_type.compressible && identity.size() >= kMinCompressedSize && identity.size() < kMinStreamedSize && std::ranges::none_of(asset.representations, [](const auto& representation) { return representation.encoding == "gzip"; })) {
+            if (auto compressed = gzipCompress(identity); compressed && compressed->size() < identity.size()) {
+                asset.representations.push_back({.encoding = "gzip", .storage = std::move(*compressed), .owned = true});
+            }
+        }
+#endif
+        // each encoding is a different representation, and thus needs its own strong entity tag
+        for (auto& representation : asset.representations | std::views::filter([](const auto& r) { return r.etag.empty(); })) {
+            representation.etag = entityTag(representation.content());
+        }
+    }
+};
+
+} // namespace detail
+
 template<typename Mode, typename VirtualFS, role... Roles>
 class FileServerRestBackend : public RestBackend<Mode, VirtualFS, Roles...> {
 private:
     using super_t = RestBackend<Mode, VirtualFS, Roles...>;
-    std::filesystem::path _serverRoot;
+    std::filesystem::path         _serverRoot;
+    detail::AssetCache<VirtualFS> _assets;
     using super_t::_svr;
     using super_t::DEFAULT_REST_SCHEME;
 
@@ -17,7 +463,7 @@ public:
     using super_t::RestBackend;
 
     FileServerRestBackend(Broker<Roles...> &broker, const VirtualFS &vfs, std::filesystem::path serverRoot, opencmw::URI<> restAddress = opencmw::URI<>::factory().scheme(DEFAULT_REST_SCHEME).hostName("0.0.0.0").port(DEFAULT_REST_PORT).build())
-        : super_t(broker, vfs, restAddress), _serverRoot(std::move(serverRoot)) {
+        : super_t(broker, vfs, restAddress), _serverRoot(std::move(serverRoot)), _assets(vfs, _serverRoot) {
     }
 
     void registerHandlers() override {
@@ -25,54 +471,62 @@ public:
             response.set_content("", "text/plain");
         });
 
-        auto contentTypeForFilename = [](const auto &path) {
-            std::string contentType;
-            if (path.ends_with(".js")) {
-                contentType = "application/javascript";
-            } else if (path.ends_with(".wasm")) {
-                contentType = "application/wasm";
-            } else if (path.ends_with(".html")) {
-                contentType = "text/html";
-            }
-            return contentType;
-        };
-
-        auto cmrcHandler = [this, contentTypeForFilename](const httplib::Request &request, httplib::Response &response) {
+        auto cmrcHandler = [this](const httplib::Request &request, httplib::Response &response) {
+            // headers required for using the SharedArrayBuffer
             response.set_header("Cross-Origin-Opener-Policy", "same-origin");
             response.set_header("Cross-Origin-Embedder-Policy", "require-corp");
 
-            auto       path        = request.path;
-            const auto contentType = contentTypeForFilename(path);
-
+            auto path = request.path;
             if (path.empty()) {
                 path = "index.html";
             }
 
-            std::string_view trimmedPath(
-                    std::ranges::find_if_not(path, [](char c) { return c == '/'; }),
-                    path.cend());
-
-            if (super_t::_vfs.is_file(path)) {
-                // headers required for using the SharedArrayBuffer
-                // webworkers and wasm can only be executed if they have the correct mimetype
-                auto file = super_t::_vfs.open(path);
-                response.set_content(std::string(file.begin(), file.end()), contentType);
-
-            } else if (auto filePath = _serverRoot / trimmedPath; sfs::exists(filePath)) {
-                std::ifstream inFile(filePath);
-                std::string   data;
-
-                inFile.seekg(0, std::ios::end);
-                data.reserve(inFile.tellg());
-                inFile.seekg(0, std::ios::beg);
-
-                data.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
-                response.set_content(std::move(data), contentType);
-
-            } else {
+            const auto asset = _assets.find(path);
+            if (!asset) {
                 std::cerr << "File not found: " << _serverRoot / request.path << std::endl;
                 response.set_content("Not found", "text/plain");
+                return;
+            }
+
+            // clients may keep the content but have to revalidate it, which costs only a 304 while the ETag matches
+            // partial downloads address bytes of the unencoded file, so Range requests always get the identity
+            const auto& representation = request.ranges.empty() ? asset->select(request.get_header_value("Accept-Encoding")) : asset->representations.front();
+            const auto  contentType    = std::string(asset->content_type.content_type);
+            response.set_header("ETag", representation.etag);
+            response.set_header("Cache-Control", "no-cache");
+            response.set_header("Accept-Ranges", "bytes");
+            if (asset->representations.size() > 1) {
+                response.set_header("Vary", "Accept-Encoding");
+            }
+            if (detail::entityTagMatches(request.get_header_value("If-None-Match"), representation.etag)) {
+                response.status = 304;
+                return;
+            }
+            if (!representation.encoding.empty()) {
+                response.set_header("Content-Encoding", representation.encoding);
+            }
+            const auto size = representation.size();
+            if (!request.ranges.empty()) {
+                if (request.has_header("If-Range") && request.get_header_value("If-Range") != representation.etag) {
+                    response.status = 200; // changed since the client's partial download, send all of it
+                } else if (!detail::rangesSatisfiable(request.ranges, size)) {
+                    response.status = 416;
+                    response.set_header("Content-Range", fmt::format("bytes */{}", size));
+                    return;
+                }
+                // otherwise httplib answers 206 with the requested ranges of the content provider below
+            }
+
+            // webworkers and wasm can only be executed if they have the correct mimetype
+            if (size == 0) {
+                response.set_content("", contentType);
+                return;
             }
+            // stream directly from the shared cache entry (or the open file), which the provider keeps alive until the response is sent
+            const auto index = static_cast<std::size_t>(&representation - asset->representations.data());
+            response.set_content_provider(size, contentType, [asset, index, buffer = std::string()](std::size_t offset, std::size_t length, httplib::DataSink &sink) mutable {
+                return asset->representations[index].write(offset, length, sink, buffer);
+            });
         };
 
         _svr.Get("/assets/.*", cmrcHandler);
@@ -8,6 +8,7 @@
 #include <IoSerialiserYaS.hpp>
 #include <MdpMessage.hpp>
 #include <RestClient.hpp>
+#include <algorithm>
 #include <opencmw.hpp>
 #include <type_traits>
 
@@ -18,13 +19,14 @@ requires std::is_floating_point_v<T>
 struct RemoteSource : public gr::Block<RemoteSource<T>> {
     gr::PortOut<T>              out;
     std::string                 remote_uri;
+    std::string                 sample_format = "float"; // TimeDomainContext::sampleFormat requested unless remote_uri sets one, "int16" halves the bandwidth
     std::string                 signal_name;
     std::string                 signal_unit;
     float                       signal_min;
     float                       signal_max;
     opencmw::client::RestClient _client;
 
-    GR_MAKE_REFLECTABLE(RemoteSource, out, remote_uri, signal_name, signal_unit, signal_min, signal_max);
+    GR_MAKE_REFLECTABLE(RemoteSource, out, remote_uri, sample_format, signal_name, signal_unit, signal_min, signal_max);
 
     struct Data {
         opendigitizer::acq::Acquisition acq;
@@ -38,6 +40,27 @@ struct RemoteSource : public gr::Block<RemoteSource<T>> {
 
     std::shared_ptr<Queue> _queue = std::make_shared<Queue>();
 
+    /// Converts raw integer sample codes (TimeDomainContext::sampleFormat "int16"/"int32") to the float values in channelValue
+    static void unpackRawSamples(opendigitizer::acq::Acquisition& acq) {
+        auto unpack = [&acq](const auto& codes) {
+            acq.channelValue.resize(codes.size());
+            std::ranges::transform(codes, acq.channelValue.begin(), [scale = acq.channelRawScale.value(), offset = acq.channelRawOffset.value()](auto code) { return static_cast<float>(offset + scale * static_cast<double>(code)); });
+        };
+        if (!acq.channelRawValueInt16.value().empty()) {
+            unpack(acq.channelRawValueInt16.value());
+        } else if (!acq.channelRawValueInt32.value().empty()) {
+            unpack(acq.channelRawValueInt32.value());
+        }
+    }
+
+    /// remote_uri with the requested sample format added to its query
+    std::string subscriptionUri() const {
+        if (sample_format.empty() || sample_format == "float" || remote_uri.find("sampleFormat=") != std::string::npos) {
+            return remote_uri;
+        }
+        return fmt::format("{}{}sampleFormat={}", remote_uri, remote_uri.find('?') == std::string::npos ? '?' : '&', sample_format);
+    }
+
     void updateSettingsFromAcquisition(const opendigitizer::acq::Acquisition& acq) {
         if (signal_name != acq.channelName.value() || signal_unit != acq.channelUnit.value() || signal_min != acq.channelRangeMin.value() || signal_max != acq.channelRangeMax.value()) {
             this->settings().set({{"signal_name", acq.channelName.value()}, {"signal_unit", acq.channelUnit.value()}, {"signal_min", acq.channelRangeMin.value()}, {"signal_max", acq.channelRangeMax.value()}});
@@ -87,8 +110,8 @@ struct RemoteSource : public gr::Block<RemoteSource<T>> {
 
         opencmw::client::Command command;
         command.command = opencmw::mdp::Command::Subscribe;
-        command.topic   = opencmw::URI<>(remote_uri);
-        fmt::print("Subscribing to {}\n", remote_uri);
+        command.topic   = opencmw::URI<>(subscriptionUri());
+        fmt::print("Subscribing to {}\n", command.topic.str());
 
         std::weak_ptr maybeQueue = _queue;
 
@@ -104,6 +127,7 @@ struct RemoteSource : public gr::Block<RemoteSource<T>> {
                 auto                            buf = rep.data;
                 opendigitizer::acq::Acquisition acq;
                 opencmw::deserialise<opencmw::YaS, opencmw::ProtocolCheck::IGNORE>(buf, acq);
+                unpackRawSamples(acq);
                 std::lock_guard lock(queue->mutex);
                 queue->data.push_back({std::move(acq), 0});
             } catch (opencmw::ProtocolException& e) {